@@ -0,0 +1,244 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+// Compares TriangleBVH queries against brute-force loops over all triangles.
+// The results of both are checked to agree before timings are reported.
+
+// standard includes
+#include <stdio.h>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/bvh.h>
+#include <sbpl_geometry_utils/intersect.h>
+#include <sbpl_geometry_utils/mesh_utils.h>
+
+using namespace sbpl;
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedMs(const Clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static bool BruteForceRay(
+    const std::vector<Triangle>& triangles,
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& direction,
+    double& t_hit)
+{
+    bool hit = false;
+    t_hit = std::numeric_limits<double>::infinity();
+    for (const Triangle& tr : triangles) {
+        const Eigen::Vector3d e1 = tr.b - tr.a;
+        const Eigen::Vector3d e2 = tr.c - tr.a;
+        const Eigen::Vector3d p = direction.cross(e2);
+        const double det = e1.dot(p);
+        if (std::fabs(det) < 1.0e-12) {
+            continue;
+        }
+        const double inv_det = 1.0 / det;
+        const Eigen::Vector3d s = origin - tr.a;
+        const double u = s.dot(p) * inv_det;
+        if (u < 0.0 || u > 1.0) {
+            continue;
+        }
+        const Eigen::Vector3d q = s.cross(e1);
+        const double v = direction.dot(q) * inv_det;
+        if (v < 0.0 || u + v > 1.0) {
+            continue;
+        }
+        const double t = e2.dot(q) * inv_det;
+        if (t >= 0.0 && t < t_hit) {
+            t_hit = t;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+static std::vector<Triangle> MakeTriangles(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices)
+{
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        triangles.push_back(Triangle(
+                vertices[indices[i]],
+                vertices[indices[i + 1]],
+                vertices[indices[i + 2]]));
+    }
+    return triangles;
+}
+
+int main()
+{
+    const int query_count = 2000;
+
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    CreateIndexedSphereMesh(1.0, 200, 200, vertices, indices);
+    const std::vector<Triangle> triangles = MakeTriangles(vertices, indices);
+
+    Clock::time_point start = Clock::now();
+    TriangleBVH bvh(vertices, indices);
+    printf("%zu triangles, build %.1f ms\n", triangles.size(), ElapsedMs(start));
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> coord(-2.0, 2.0);
+    std::vector<Eigen::Vector3d> points(query_count);
+    std::vector<Eigen::Vector3d> directions(query_count);
+    for (int i = 0; i < query_count; ++i) {
+        points[i] = Eigen::Vector3d(coord(rng), coord(rng), coord(rng));
+        directions[i] = (-points[i] + 0.3 * Eigen::Vector3d(
+                coord(rng), coord(rng), coord(rng))).normalized();
+    }
+
+    int mismatches = 0;
+
+    // rays
+    std::vector<double> bvh_t(query_count);
+    std::vector<bool> bvh_hit(query_count);
+    start = Clock::now();
+    for (int i = 0; i < query_count; ++i) {
+        double t;
+        int tri;
+        bvh_hit[i] = bvh.intersectRay(
+                points[i], directions[i],
+                std::numeric_limits<double>::infinity(), t, tri);
+        bvh_t[i] = t;
+    }
+    const double bvh_ray_ms = ElapsedMs(start);
+    start = Clock::now();
+    for (int i = 0; i < query_count; ++i) {
+        double t;
+        const bool hit = BruteForceRay(triangles, points[i], directions[i], t);
+        if (hit != bvh_hit[i] || (hit && std::fabs(t - bvh_t[i]) > 1.0e-9)) {
+            ++mismatches;
+        }
+    }
+    const double brute_ray_ms = ElapsedMs(start);
+
+    // closest points
+    std::vector<double> bvh_dist(query_count);
+    start = Clock::now();
+    for (int i = 0; i < query_count; ++i) {
+        Eigen::Vector3d closest;
+        int tri;
+        bvh.closestPoint(points[i], closest, tri);
+        bvh_dist[i] = (closest - points[i]).norm();
+    }
+    const double bvh_closest_ms = ElapsedMs(start);
+    start = Clock::now();
+    for (int i = 0; i < query_count; ++i) {
+        double best = std::numeric_limits<double>::infinity();
+        for (const Triangle& tr : triangles) {
+            best = std::min(best, (ClosestPointOnTriangle(points[i], tr) - points[i]).norm());
+        }
+        if (std::fabs(best - bvh_dist[i]) > 1.0e-9) {
+            ++mismatches;
+        }
+    }
+    const double brute_closest_ms = ElapsedMs(start);
+
+    // axis-aligned box overlap, counted by bounding box overlap
+    std::vector<size_t> bvh_counts(query_count);
+    const Eigen::Vector3d half(0.1, 0.1, 0.1);
+    start = Clock::now();
+    std::vector<int> overlapping;
+    for (int i = 0; i < query_count; ++i) {
+        overlapping.clear();
+        bvh.overlapAABB(points[i] - half, points[i] + half, overlapping);
+        bvh_counts[i] = overlapping.size();
+    }
+    const double bvh_box_ms = ElapsedMs(start);
+    start = Clock::now();
+    for (int i = 0; i < query_count; ++i) {
+        const Eigen::Vector3d min = points[i] - half;
+        const Eigen::Vector3d max = points[i] + half;
+        size_t count = 0;
+        for (const Triangle& tr : triangles) {
+            const Eigen::Vector3d tmin = tr.a.cwiseMin(tr.b).cwiseMin(tr.c);
+            const Eigen::Vector3d tmax = tr.a.cwiseMax(tr.b).cwiseMax(tr.c);
+            count += (tmin.array() <= max.array()).all() &&
+                    (tmax.array() >= min.array()).all();
+        }
+        if (count != bvh_counts[i]) {
+            ++mismatches;
+        }
+    }
+    const double brute_box_ms = ElapsedMs(start);
+
+    // mesh versus mesh, on coarser meshes to keep the brute force tractable
+    std::vector<Eigen::Vector3d> va, vb;
+    std::vector<int> ia, ib;
+    CreateIndexedSphereMesh(1.0, 40, 40, va, ia);
+    CreateIndexedSphereMesh(0.8, 40, 40, vb, ib);
+    for (Eigen::Vector3d& v : vb) {
+        v += Eigen::Vector3d(1.2, 0.3, 0.1);
+    }
+    const TriangleBVH bvh_a(va, ia);
+    const TriangleBVH bvh_b(vb, ib);
+    std::vector<std::pair<int, int>> pairs;
+    start = Clock::now();
+    bvh_a.intersectingTriangles(bvh_b, pairs);
+    const double bvh_mesh_ms = ElapsedMs(start);
+    start = Clock::now();
+    const std::vector<Triangle> ta = MakeTriangles(va, ia);
+    const TriangleArray tb(vb, ib);
+    size_t brute_pairs = 0;
+    std::vector<int> hits;
+    for (const Triangle& tr : ta) {
+        hits.clear();
+        IntersectingTriangles(tr, tb, hits);
+        brute_pairs += hits.size();
+    }
+    const double brute_mesh_ms = ElapsedMs(start);
+    if (brute_pairs != pairs.size()) {
+        ++mismatches;
+    }
+
+    printf("%-16s %10s %12s %8s\n", "query", "bvh (ms)", "brute (ms)", "speedup");
+    printf("%-16s %10.2f %12.2f %7.0fx\n", "ray", bvh_ray_ms, brute_ray_ms, brute_ray_ms / bvh_ray_ms);
+    printf("%-16s %10.2f %12.2f %7.0fx\n", "closest point", bvh_closest_ms, brute_closest_ms, brute_closest_ms / bvh_closest_ms);
+    printf("%-16s %10.2f %12.2f %7.0fx\n", "box overlap", bvh_box_ms, brute_box_ms, brute_box_ms / bvh_box_ms);
+    printf("%-16s %10.2f %12.2f %7.0fx\n", "mesh vs mesh", bvh_mesh_ms, brute_mesh_ms, brute_mesh_ms / bvh_mesh_ms);
+    printf("%d mismatches\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+// Times VoxelizeMesh in each separability mode on a sphere, a rotated box, and
+// a tilted cylinder, and checks the surfaces it produces: Six surfaces enclose
+// their interior under 6-connectivity, Six and Conservative surfaces are both
+// subsets of TwentySix surfaces, and Conservative surfaces contain the cell of
+// every point sampled on the triangles.
+
+// standard includes
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <random>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/mesh_utils.h>
+#include <sbpl_geometry_utils/voxel_grid.h>
+#include <sbpl_geometry_utils/voxelize.h>
+
+using namespace sbpl;
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedMs(const Clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Mesh
+{
+    const char* name;
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+};
+
+static void TransformMesh(const Eigen::Affine3d& pose, Mesh& mesh)
+{
+    for (Eigen::Vector3d& v : mesh.vertices) {
+        v = pose * v;
+    }
+}
+
+// Return the number of empty cells that cannot be reached from the border of
+// the grid through empty cells sharing a face
+static int CountEnclosedCells(const VoxelGrid<HalfResDiscretizer>& vg)
+{
+    const int sx = vg.sizeX();
+    const int sy = vg.sizeY();
+    const int sz = vg.sizeZ();
+    std::vector<bool> visited((size_t)sx * sy * sz, false);
+    std::deque<MemoryCoord> open;
+    auto visit = [&](int x, int y, int z)
+    {
+        if (x < 0 || x >= sx || y < 0 || y >= sy || z < 0 || z >= sz) {
+            return;
+        }
+        const size_t i = ((size_t)x * sy + y) * sz + z;
+        if (visited[i] || vg[MemoryCoord(x, y, z)]) {
+            return;
+        }
+        visited[i] = true;
+        open.push_back(MemoryCoord(x, y, z));
+    };
+
+    for (int x = 0; x < sx; ++x) {
+        for (int y = 0; y < sy; ++y) {
+            for (int z = 0; z < sz; ++z) {
+                if (x == 0 || y == 0 || z == 0 ||
+                    x == sx - 1 || y == sy - 1 || z == sz - 1)
+                {
+                    visit(x, y, z);
+                }
+            }
+        }
+    }
+
+    while (!open.empty()) {
+        const MemoryCoord mc = open.front();
+        open.pop_front();
+        visit(mc.x - 1, mc.y, mc.z);
+        visit(mc.x + 1, mc.y, mc.z);
+        visit(mc.x, mc.y - 1, mc.z);
+        visit(mc.x, mc.y + 1, mc.z);
+        visit(mc.x, mc.y, mc.z - 1);
+        visit(mc.x, mc.y, mc.z + 1);
+    }
+
+    int enclosed = 0;
+    for (size_t i = 0; i < visited.size(); ++i) {
+        enclosed += !visited[i] && !vg.data()[i];
+    }
+    return enclosed;
+}
+
+// Return the number of cells occupied in a but not in b
+static int CountMissing(
+    const VoxelGrid<HalfResDiscretizer>& a,
+    const VoxelGrid<HalfResDiscretizer>& b)
+{
+    const size_t count = (size_t)a.sizeX() * a.sizeY() * a.sizeZ();
+    int missing = 0;
+    for (size_t i = 0; i < count; ++i) {
+        missing += a.data()[i] && !b.data()[i];
+    }
+    return missing;
+}
+
+// Return the number of points sampled on the triangles of a mesh whose cells
+// are not occupied
+static int CountUncoveredSamples(
+    const Mesh& mesh,
+    const VoxelGrid<HalfResDiscretizer>& vg)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    int uncovered = 0;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const Eigen::Vector3d& a = mesh.vertices[mesh.indices[i]];
+        const Eigen::Vector3d& b = mesh.vertices[mesh.indices[i + 1]];
+        const Eigen::Vector3d& c = mesh.vertices[mesh.indices[i + 2]];
+        for (int k = 0; k < 200; ++k) {
+            double s = u(rng);
+            double t = u(rng);
+            if (s + t > 1.0) {
+                s = 1.0 - s;
+                t = 1.0 - t;
+            }
+            const Eigen::Vector3d p = a + s * (b - a) + t * (c - a);
+            uncovered += !vg[WorldCoord(p.x(), p.y(), p.z())];
+        }
+    }
+    return uncovered;
+}
+
+int main()
+{
+    const double res = 0.01;
+    const int runs = 3;
+
+    std::vector<Mesh> meshes(3);
+    meshes[0].name = "sphere r=0.4";
+    CreateIndexedSphereMesh(0.4, 40, 40, meshes[0].vertices, meshes[0].indices);
+    meshes[1].name = "rotated box";
+    CreateIndexedBoxMesh(
+            0.6, 0.4, 0.3, meshes[1].vertices, meshes[1].indices);
+    TransformMesh(
+            Eigen::Affine3d(Eigen::AngleAxisd(
+                    0.5, Eigen::Vector3d(1.0, 2.0, 3.0).normalized())),
+            meshes[1]);
+    meshes[2].name = "tilted cylinder";
+    CreateIndexedCylinderMesh(
+            0.2, 0.8, meshes[2].vertices, meshes[2].indices);
+    TransformMesh(
+            Eigen::Affine3d(Eigen::AngleAxisd(
+                    0.7, Eigen::Vector3d(1.0, 0.0, 1.0).normalized())),
+            meshes[2]);
+
+    const Separability seps[3] = {
+        Separability::Six, Separability::TwentySix, Separability::Conservative
+    };
+
+    int failures = 0;
+
+    printf("%-17s %17s %17s %17s\n",
+            "voxels, ms", "Six", "TwentySix", "Conservative");
+    for (const Mesh& mesh : meshes) {
+        Eigen::Vector3d min;
+        Eigen::Vector3d max;
+        ComputeAxisAlignedBoundingBox(mesh.vertices, min, max);
+        const Eigen::Vector3d pad = Eigen::Vector3d::Constant(3.0 * res);
+
+        std::vector<VoxelGrid<HalfResDiscretizer>> grids;
+        printf("%-17s", mesh.name);
+        for (Separability sep : seps) {
+            std::vector<Eigen::Vector3d> voxels;
+            double best_ms = std::numeric_limits<double>::infinity();
+            for (int r = 0; r < runs; ++r) {
+                voxels.clear();
+                const Clock::time_point start = Clock::now();
+                VoxelizeMesh(
+                        mesh.vertices, mesh.indices, res, voxels, false, sep);
+                best_ms = std::min(best_ms, ElapsedMs(start));
+            }
+            printf(" %10zu %6.1f", voxels.size(), best_ms);
+
+            grids.push_back(VoxelGrid<HalfResDiscretizer>(
+                    min - pad, max - min + 2.0 * pad,
+                    Eigen::Vector3d(res, res, res),
+                    HalfResDiscretizer(res),
+                    HalfResDiscretizer(res),
+                    HalfResDiscretizer(res)));
+            VoxelizeMesh(mesh.vertices, mesh.indices, grids.back(), false, sep);
+        }
+        printf("\n");
+
+        const int enclosed = CountEnclosedCells(grids[0]);
+        const int six_extra = CountMissing(grids[0], grids[1]);
+        const int conservative_extra = CountMissing(grids[2], grids[1]);
+        const int uncovered = CountUncoveredSamples(mesh, grids[2]);
+        if (enclosed == 0 || six_extra != 0 || conservative_extra != 0 ||
+            uncovered != 0)
+        {
+            printf("  enclosed %d, Six not in TwentySix %d, "
+                    "Conservative not in TwentySix %d, uncovered samples %d\n",
+                    enclosed, six_extra, conservative_extra, uncovered);
+            ++failures;
+        }
+    }
+
+    printf("%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
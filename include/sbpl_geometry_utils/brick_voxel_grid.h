@@ -0,0 +1,331 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_brick_voxel_grid_h
+#define sbpl_geometry_brick_voxel_grid_h
+
+// standard includes
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+#include <sbpl_geometry_utils/voxel_key.h>
+
+namespace sbpl {
+
+/// \brief Unbounded, sparse voxel grid made up of fixed-size bricks
+///
+/// Bricks of BRICK_SIZE^3 cells are allocated the first time one of their
+/// cells is written, so memory grows with the number of bricks touched rather
+/// than with the extents of the voxelized geometry. Reading a cell that lies
+/// in an unallocated brick returns 0.
+template <class Discretizer>
+class BrickVoxelGrid
+{
+public:
+
+    typedef unsigned char value_type;
+
+    static const int BRICK_SIZE = 8;
+    static const int BRICK_CELL_COUNT = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+    struct Brick
+    {
+        GridCoord origin; // grid coordinate of the brick's first cell
+        value_type cells[BRICK_CELL_COUNT];
+    };
+
+    BrickVoxelGrid(
+        const Eigen::Vector3d& res,
+        const Discretizer& x_disc,
+        const Discretizer& y_disc,
+        const Discretizer& z_disc);
+
+    const Eigen::Vector3d& res() const { return m_res; }
+
+    size_t brickCount() const { return m_bricks.size(); }
+    const std::deque<Brick>& bricks() const { return m_bricks; }
+
+    void clear();
+
+    value_type& operator()(const GridCoord& coord);
+    value_type& operator()(const WorldCoord& coord);
+    value_type& operator[](const GridCoord& coord);
+    value_type& operator[](const WorldCoord& coord);
+
+    value_type operator()(const GridCoord& coord) const;
+    value_type operator()(const WorldCoord& coord) const;
+    value_type operator[](const GridCoord& coord) const;
+    value_type operator[](const WorldCoord& coord) const;
+
+    GridCoord worldToGrid(const WorldCoord& coord) const;
+    WorldCoord gridToWorld(const GridCoord& coord) const;
+
+private:
+
+    Eigen::Vector3d m_res;
+
+    Discretizer m_x_disc;
+    Discretizer m_y_disc;
+    Discretizer m_z_disc;
+
+    // bricks never move once allocated, so references to their cells remain
+    // valid as further bricks are allocated
+    std::deque<Brick> m_bricks;
+    std::unordered_map<VoxelKey, int> m_brick_index;
+
+    // the most recently written brick, to skip the hash lookup for runs of
+    // writes to the same brick
+    VoxelKey m_last_key;
+    int m_last_brick;
+
+    static int FloorDiv(int v)
+    {
+        return v >= 0 ? v / BRICK_SIZE : (v + 1) / BRICK_SIZE - 1;
+    }
+
+    static int CellIndex(const GridCoord& coord, const GridCoord& origin)
+    {
+        return ((coord.x - origin.x) * BRICK_SIZE + (coord.y - origin.y)) *
+                BRICK_SIZE + (coord.z - origin.z);
+    }
+};
+
+template <class Discretizer>
+void ExtractVoxels(
+    const BrickVoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& voxels);
+
+template <class Discretizer>
+const int BrickVoxelGrid<Discretizer>::BRICK_SIZE;
+
+template <class Discretizer>
+const int BrickVoxelGrid<Discretizer>::BRICK_CELL_COUNT;
+
+template <class Discretizer>
+BrickVoxelGrid<Discretizer>::BrickVoxelGrid(
+    const Eigen::Vector3d& res,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc)
+:
+    m_res(res),
+    m_x_disc(x_disc),
+    m_y_disc(y_disc),
+    m_z_disc(z_disc),
+    m_bricks(),
+    m_brick_index(),
+    m_last_key(),
+    m_last_brick(-1)
+{
+}
+
+template <class Discretizer>
+void BrickVoxelGrid<Discretizer>::clear()
+{
+    m_bricks.clear();
+    m_brick_index.clear();
+    m_last_brick = -1;
+}
+
+template <class Discretizer>
+typename BrickVoxelGrid<Discretizer>::value_type&
+BrickVoxelGrid<Discretizer>::operator()(const GridCoord& coord)
+{
+    const int bx = FloorDiv(coord.x);
+    const int by = FloorDiv(coord.y);
+    const int bz = FloorDiv(coord.z);
+    const VoxelKey key(bx, by, bz);
+    if (m_last_brick == -1 || key != m_last_key) {
+        auto it = m_brick_index.find(key);
+        if (it == m_brick_index.end()) {
+            Brick brick;
+            brick.origin = GridCoord(
+                    bx * BRICK_SIZE, by * BRICK_SIZE, bz * BRICK_SIZE);
+            std::fill(brick.cells, brick.cells + BRICK_CELL_COUNT, 0);
+            it = m_brick_index.insert(
+                    std::make_pair(key, (int)m_bricks.size())).first;
+            m_bricks.push_back(brick);
+        }
+        m_last_key = key;
+        m_last_brick = it->second;
+    }
+    Brick& brick = m_bricks[m_last_brick];
+    return brick.cells[CellIndex(coord, brick.origin)];
+}
+
+template <class Discretizer>
+typename BrickVoxelGrid<Discretizer>::value_type&
+BrickVoxelGrid<Discretizer>::operator()(const WorldCoord& coord)
+{
+    return (*this)(worldToGrid(coord));
+}
+
+template <class Discretizer>
+typename BrickVoxelGrid<Discretizer>::value_type&
+BrickVoxelGrid<Discretizer>::operator[](const GridCoord& coord)
+{
+    return (*this)(coord);
+}
+
+template <class Discretizer>
+typename BrickVoxelGrid<Discretizer>::value_type&
+BrickVoxelGrid<Discretizer>::operator[](const WorldCoord& coord)
+{
+    return (*this)(worldToGrid(coord));
+}
+
+template <class Discretizer>
+typename BrickVoxelGrid<Discretizer>::value_type
+BrickVoxelGrid<Discretizer>::operator()(const GridCoord& coord) const
+{
+    const VoxelKey key(FloorDiv(coord.x), FloorDiv(coord.y), FloorDiv(coord.z));
+    auto it = m_brick_index.find(key);
+    if (it == m_brick_index.end()) {
+        return 0;
+    }
+    const Brick& brick = m_bricks[it->second];
+    return brick.cells[CellIndex(coord, brick.origin)];
+}
+
+template <class Discretizer>
+typename BrickVoxelGrid<Discretizer>::value_type
+BrickVoxelGrid<Discretizer>::operator()(const WorldCoord& coord) const
+{
+    return (*this)(worldToGrid(coord));
+}
+
+template <class Discretizer>
+typename BrickVoxelGrid<Discretizer>::value_type
+BrickVoxelGrid<Discretizer>::operator[](const GridCoord& coord) const
+{
+    return (*this)(coord);
+}
+
+template <class Discretizer>
+typename BrickVoxelGrid<Discretizer>::value_type
+BrickVoxelGrid<Discretizer>::operator[](const WorldCoord& coord) const
+{
+    return (*this)(worldToGrid(coord));
+}
+
+template <class Discretizer>
+GridCoord
+BrickVoxelGrid<Discretizer>::worldToGrid(const WorldCoord& coord) const
+{
+    return GridCoord(
+            m_x_disc.discretize(coord.x),
+            m_y_disc.discretize(coord.y),
+            m_z_disc.discretize(coord.z));
+}
+
+template <class Discretizer>
+WorldCoord
+BrickVoxelGrid<Discretizer>::gridToWorld(const GridCoord& coord) const
+{
+    return WorldCoord(
+            m_x_disc.continuize(coord.x),
+            m_y_disc.continuize(coord.y),
+            m_z_disc.continuize(coord.z));
+}
+
+/// \brief Append the centers of all occupied cells to a vector of voxels
+///
+/// Voxels are ordered by brick allocation order and then by memory order within
+/// each brick.
+template <class Discretizer>
+void ExtractVoxels(
+    const BrickVoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& voxels)
+{
+    typedef BrickVoxelGrid<Discretizer> Grid;
+    for (const typename Grid::Brick& brick : vg.bricks()) {
+        int i = 0;
+        for (int x = 0; x < Grid::BRICK_SIZE; ++x) {
+            for (int y = 0; y < Grid::BRICK_SIZE; ++y) {
+                for (int z = 0; z < Grid::BRICK_SIZE; ++z, ++i) {
+                    if (brick.cells[i]) {
+                        const WorldCoord wc = vg.gridToWorld(GridCoord(
+                                brick.origin.x + x,
+                                brick.origin.y + y,
+                                brick.origin.z + z));
+                        voxels.push_back(Eigen::Vector3d(wc.x, wc.y, wc.z));
+                    }
+                }
+            }
+        }
+    }
+}
+
+///////////////////////////
+// HalfResBrickVoxelGrid //
+///////////////////////////
+
+class HalfResBrickVoxelGrid : public BrickVoxelGrid<HalfResDiscretizer>
+{
+public:
+
+    HalfResBrickVoxelGrid(const Eigen::Vector3d& res) :
+        BrickVoxelGrid(
+            res,
+            HalfResDiscretizer(res.x()),
+            HalfResDiscretizer(res.y()),
+            HalfResDiscretizer(res.z()))
+    { }
+};
+
+/////////////////////////
+// PivotBrickVoxelGrid //
+/////////////////////////
+
+class PivotBrickVoxelGrid : public BrickVoxelGrid<PivotDiscretizer>
+{
+public:
+
+    PivotBrickVoxelGrid(
+        const Eigen::Vector3d& res,
+        const Eigen::Vector3d& pivot)
+    :
+        BrickVoxelGrid(
+            res,
+            PivotDiscretizer(res.x(), pivot.x()),
+            PivotDiscretizer(res.y(), pivot.y()),
+            PivotDiscretizer(res.z(), pivot.z()))
+    { }
+};
+
+} // namespace sbpl
+
+#endif
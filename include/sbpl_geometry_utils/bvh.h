@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_bvh_h
+#define sbpl_geometry_bvh_h
+
+// standard includes
+#include <utility>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/triangle.h>
+
+namespace sbpl {
+
+/// \brief Bounding volume hierarchy over the triangles of an indexed mesh
+///
+/// The hierarchy is built top-down using the binned surface area heuristic and
+/// stored as a flat array of nodes in depth-first order. Each node stores the
+/// index of the node following its subtree, so queries traverse the tree
+/// without a stack. Triangle indices reported by queries refer to the position
+/// of the triangle in the input index list, i.e. triangle i is made up of the
+/// vertices indices[3 * i], indices[3 * i + 1], and indices[3 * i + 2].
+class TriangleBVH
+{
+public:
+
+    struct Node
+    {
+        Eigen::Vector3d min;
+        Eigen::Vector3d max;
+
+        /// index of the first triangle (leaves only)
+        int first;
+
+        /// number of triangles; 0 for interior nodes
+        int count;
+
+        /// index of the next node in depth-first order not in this subtree
+        int skip;
+    };
+
+    TriangleBVH();
+
+    TriangleBVH(
+        const std::vector<Eigen::Vector3d>& vertices,
+        const std::vector<int>& indices,
+        int max_leaf_size = 4);
+
+    void build(
+        const std::vector<Eigen::Vector3d>& vertices,
+        const std::vector<int>& indices,
+        int max_leaf_size = 4);
+
+    bool empty() const { return m_nodes.empty(); }
+    int triangleCount() const { return (int)m_triangles.size(); }
+    const std::vector<Node>& nodes() const { return m_nodes; }
+
+    bool intersectRay(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& direction,
+        double max_t,
+        double& t,
+        int& triangle) const;
+
+    void overlapAABB(
+        const Eigen::Vector3d& min,
+        const Eigen::Vector3d& max,
+        std::vector<int>& triangles) const;
+
+    bool closestPoint(
+        const Eigen::Vector3d& p,
+        Eigen::Vector3d& closest,
+        int& triangle) const;
+
+    bool intersects(const TriangleBVH& other) const;
+
+    void intersectingTriangles(
+        const TriangleBVH& other,
+        std::vector<std::pair<int, int>>& pairs) const;
+
+private:
+
+    std::vector<Node> m_nodes;
+
+    // triangles and their input indices, stored in leaf order
+    std::vector<Triangle> m_triangles;
+    std::vector<int> m_triangle_ids;
+
+    template <typename Visitor>
+    void visitAABB(
+        const Eigen::Vector3d& min,
+        const Eigen::Vector3d& max,
+        Visitor visit) const;
+
+    template <typename Visitor>
+    bool findIntersections(const TriangleBVH& other, Visitor visit) const;
+};
+
+} // namespace sbpl
+
+#endif
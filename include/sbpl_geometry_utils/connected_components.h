@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_connected_components_h
+#define sbpl_geometry_connected_components_h
+
+// standard includes
+#include <vector>
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+/// \brief Summary of a connected component of occupied voxels
+struct VoxelComponent
+{
+    int label;      ///< label of the component's cells in the label grid
+    int count;      ///< number of cells in the component
+    GridCoord min;  ///< inclusive lower corner of the component's bounding box
+    GridCoord max;  ///< inclusive upper corner of the component's bounding box
+
+    VoxelComponent() : label(), count(), min(), max() { }
+};
+
+bool LabelConnectedComponents(
+    const unsigned char* cells,
+    int size_x,
+    int size_y,
+    int size_z,
+    int connectivity,
+    int* labels,
+    std::vector<VoxelComponent>& components);
+
+template <typename Discretizer>
+bool LabelConnectedComponents(
+    const VoxelGrid<Discretizer>& vg,
+    int connectivity,
+    VoxelGrid<Discretizer, int>& labels,
+    std::vector<VoxelComponent>& components);
+
+} // namespace sbpl
+
+#include "detail/connected_components.h"
+
+#endif
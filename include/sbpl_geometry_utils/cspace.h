@@ -0,0 +1,103 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_cspace_h
+#define sbpl_geometry_cspace_h
+
+// standard includes
+#include <cstdint>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+namespace sbpl {
+namespace raster {
+
+void RasterizeFootprint(
+    const std::vector<Eigen::Vector2d>& footprint,
+    double theta,
+    double res,
+    int radius,
+    unsigned char* grid);
+
+/// @brief Configuration-space obstacle maps of a 2D footprint over a set of
+///     discretized headings.
+///
+/// The footprint is rasterized once per heading into a template of cell
+/// offsets, and the obstacle map is correlated with each template using
+/// bitwise operations on packed rows, so that the collision status of any
+/// (x, y, heading) is then a single bit lookup. Grids follow the convention of
+/// RasterizeLine: cells are indexed as grid[width * y + x] and nonzero cells
+/// are obstacles. Footprint cells that fall outside the grid are treated as
+/// obstacles.
+class FootprintCSpace
+{
+public:
+
+    FootprintCSpace();
+
+    bool build(
+        const unsigned char* grid,
+        int width,
+        int height,
+        double res,
+        const std::vector<Eigen::Vector2d>& footprint,
+        int heading_count);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int headingCount() const { return m_heading_count; }
+
+    int headingIndex(double theta) const;
+
+    /// @brief Return whether the footprint, centered on cell (x, y) at the
+    ///     given heading index, overlaps an obstacle
+    bool collides(int x, int y, int heading) const
+    {
+        const std::uint64_t* row =
+                &m_maps[((size_t)heading * m_height + y) * m_words];
+        return (row[x >> 6] >> (x & 63)) & 1;
+    }
+
+private:
+
+    int m_width;
+    int m_height;
+    int m_heading_count;
+    int m_words;
+
+    // one packed map per heading, rows of m_words words
+    std::vector<std::uint64_t> m_maps;
+};
+
+} // end namespace raster
+} // end namespace sbpl
+
+#endif
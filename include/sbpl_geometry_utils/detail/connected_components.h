@@ -0,0 +1,75 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_detail_connected_components_h
+#define sbpl_geometry_detail_connected_components_h
+
+namespace sbpl {
+
+/// \brief Label the connected components of the occupied cells of a voxel
+///     grid
+///
+/// The label grid is reinitialized with the extents of the voxel grid. Empty
+/// cells are labeled 0 and occupied cells are labeled 1 through the number of
+/// components, in order of each component's first cell in memory order.
+/// Component bounding boxes are reported in grid coordinates.
+///
+/// \param connectivity 6, 18, or 26
+template <typename Discretizer>
+bool LabelConnectedComponents(
+    const VoxelGrid<Discretizer>& vg,
+    int connectivity,
+    VoxelGrid<Discretizer, int>& labels,
+    std::vector<VoxelComponent>& components)
+{
+    labels = VoxelGrid<Discretizer, int>(
+            vg.origin(), vg.size(), vg.res(),
+            vg.xDiscretizer(), vg.yDiscretizer(), vg.zDiscretizer());
+
+    const size_t first = components.size();
+    if (!LabelConnectedComponents(
+            vg.data(), vg.sizeX(), vg.sizeY(), vg.sizeZ(),
+            connectivity, labels.data(), components))
+    {
+        return false;
+    }
+
+    // convert bounding boxes from memory coordinates to grid coordinates
+    const GridCoord& off = vg.minGridCoord();
+    for (size_t i = first; i < components.size(); ++i) {
+        VoxelComponent& c = components[i];
+        c.min = GridCoord(c.min.x + off.x, c.min.y + off.y, c.min.z + off.z);
+        c.max = GridCoord(c.max.x + off.x, c.max.y + off.y, c.max.z + off.z);
+    }
+    return true;
+}
+
+} // namespace sbpl
+
+#endif
@@ -0,0 +1,368 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_detail_isosurface_h
+#define sbpl_geometry_detail_isosurface_h
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace sbpl {
+namespace isosurface {
+
+// Number of cube slices along x processed by each parallel task
+static const int SlabThickness = 16;
+
+// Corners of a cube are numbered by their offsets (i & 1, (i >> 1) & 1,
+// (i >> 2) & 1); each of the 12 edges joins two corners differing in one bit
+static const int EdgeCorners[12][2] = {
+    { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },     // along x
+    { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },     // along y
+    { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },     // along z
+};
+
+// Map from a mask of the inside corners of a cube to a mask of the edges
+// crossed by the surface
+inline const int* EdgeTable()
+{
+    struct Table
+    {
+        int edges[256];
+
+        Table()
+        {
+            for (int m = 0; m < 256; ++m) {
+                edges[m] = 0;
+                for (int e = 0; e < 12; ++e) {
+                    const bool a = (m >> EdgeCorners[e][0]) & 1;
+                    const bool b = (m >> EdgeCorners[e][1]) & 1;
+                    if (a != b) {
+                        edges[m] |= 1 << e;
+                    }
+                }
+            }
+        }
+    };
+    static const Table table;
+    return table.edges;
+}
+
+struct Slab
+{
+    std::vector<Eigen::Vector3d> vertices;
+
+    // local vertex indices; -(j + 1) refers to the j'th vertex of the last
+    // slice of the previous slab
+    std::vector<int> indices;
+
+    // local index of the first vertex of the last slice of this slab
+    int last_slice_start;
+
+    Slab() : vertices(), indices(), last_slice_start(0) { }
+};
+
+// Naive surface nets over the lattice of samples [-1, size] along each axis.
+// Each cube (identified by its lower corner in [-1, size - 1]) crossed by the
+// surface receives one vertex at the mean of its edge crossings, and each
+// lattice edge crossed by the surface joins the vertices of its four
+// surrounding cubes into a quad. sample(x, y, z, f) returns false for
+// samples outside the grid, which are outside the surface, and otherwise
+// sets f, which is negative inside the surface.
+template <typename Sampler>
+void ExtractSurfaceNet(
+    int size_x,
+    int size_y,
+    int size_z,
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& res,
+    const Sampler& sample,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& indices)
+{
+    const int* edge_table = EdgeTable();
+
+    const int slice_size = (size_y + 1) * (size_z + 1);
+    const int slice_count = size_x + 1; // cube slices -1 .. size_x - 1
+    const int slab_count = (slice_count + SlabThickness - 1) / SlabThickness;
+
+    std::vector<Slab> slabs(slab_count);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int s = 0; s < slab_count; ++s) {
+        Slab& slab = slabs[s];
+        const int xbegin = -1 + s * SlabThickness;
+        const int xend = std::min(xbegin + SlabThickness, size_x);
+
+        // vertex indices of the cubes of the previous and current slice
+        std::vector<int> prev(slice_size, 0);
+        std::vector<int> curr(slice_size, 0);
+
+        auto slice_index = [&](int y, int z)
+        {
+            return (y + 1) * (size_z + 1) + (z + 1);
+        };
+
+        // sample the eight corners of a cube, returning the mask of corners
+        // that are inside
+        auto sample_cube = [&](int x, int y, int z, double f[8], bool in[8])
+        {
+            int mask = 0;
+            for (int i = 0; i < 8; ++i) {
+                in[i] = sample(x + (i & 1), y + ((i >> 1) & 1), z + ((i >> 2) & 1), f[i]);
+                if (in[i] && f[i] < 0.0) {
+                    mask |= 1 << i;
+                }
+            }
+            return mask;
+        };
+
+        // compute the vertices of the cubes of a slice, appending them to
+        // the slab if store is set and numbering them as borrowed otherwise
+        auto compute_slice = [&](int x, bool store)
+        {
+            int borrowed = 0;
+            double f[8];
+            bool in[8];
+            for (int y = -1; y < size_y; ++y) {
+                for (int z = -1; z < size_z; ++z) {
+                    const int mask = sample_cube(x, y, z, f, in);
+                    const int edges = edge_table[mask];
+                    if (!edges) {
+                        continue;
+                    }
+
+                    if (!store) {
+                        curr[slice_index(y, z)] = -(++borrowed);
+                        continue;
+                    }
+
+                    Eigen::Vector3d sum(Eigen::Vector3d::Zero());
+                    int crossings = 0;
+                    for (int e = 0; e < 12; ++e) {
+                        if (!(edges & (1 << e))) {
+                            continue;
+                        }
+                        const int a = EdgeCorners[e][0];
+                        const int b = EdgeCorners[e][1];
+                        const double t = (in[a] && in[b]) ?
+                                f[a] / (f[a] - f[b]) : 0.5;
+                        const Eigen::Vector3d pa(a & 1, (a >> 1) & 1, (a >> 2) & 1);
+                        const Eigen::Vector3d pb(b & 1, (b >> 1) & 1, (b >> 2) & 1);
+                        sum += pa + t * (pb - pa);
+                        ++crossings;
+                    }
+
+                    const Eigen::Vector3d p =
+                            Eigen::Vector3d(x, y, z) + sum / crossings;
+                    curr[slice_index(y, z)] = (int)slab.vertices.size();
+                    slab.vertices.push_back(origin + p.cwiseProduct(res));
+                }
+            }
+        };
+
+        auto push_quad = [&](int c00, int c10, int c11, int c01, bool flip)
+        {
+            if (flip) {
+                std::swap(c10, c01);
+            }
+            slab.indices.push_back(c00);
+            slab.indices.push_back(c10);
+            slab.indices.push_back(c11);
+            slab.indices.push_back(c00);
+            slab.indices.push_back(c11);
+            slab.indices.push_back(c01);
+        };
+
+        if (xbegin > -1) {
+            compute_slice(xbegin - 1, false);
+            std::swap(prev, curr);
+        }
+
+        for (int x = xbegin; x < xend; ++x) {
+            if (x == xend - 1) {
+                slab.last_slice_start = (int)slab.vertices.size();
+            }
+            compute_slice(x, true);
+
+            // emit a quad for each crossed lattice edge leaving the sample
+            // at the lower corner of each cube, winding counterclockwise
+            // about the direction from the inside sample to the outside one
+            for (int y = -1; y < size_y; ++y) {
+                for (int z = -1; z < size_z; ++z) {
+                    double f0, f1;
+                    const bool in0 = sample(x, y, z, f0) && f0 < 0.0;
+                    const int c = curr[slice_index(y, z)];
+
+                    // along x, about (y, z)
+                    if (y >= 0 && z >= 0) {
+                        const bool in1 = sample(x + 1, y, z, f1) && f1 < 0.0;
+                        if (in0 != in1) {
+                            push_quad(
+                                    curr[slice_index(y - 1, z - 1)],
+                                    curr[slice_index(y, z - 1)],
+                                    c,
+                                    curr[slice_index(y - 1, z)],
+                                    !in0);
+                        }
+                    }
+                    // along y, about (z, x)
+                    if (x >= 0 && z >= 0) {
+                        const bool in1 = sample(x, y + 1, z, f1) && f1 < 0.0;
+                        if (in0 != in1) {
+                            push_quad(
+                                    prev[slice_index(y, z - 1)],
+                                    prev[slice_index(y, z)],
+                                    c,
+                                    curr[slice_index(y, z - 1)],
+                                    !in0);
+                        }
+                    }
+                    // along z, about (x, y)
+                    if (x >= 0 && y >= 0) {
+                        const bool in1 = sample(x, y, z + 1, f1) && f1 < 0.0;
+                        if (in0 != in1) {
+                            push_quad(
+                                    prev[slice_index(y - 1, z)],
+                                    curr[slice_index(y - 1, z)],
+                                    c,
+                                    prev[slice_index(y, z)],
+                                    !in0);
+                        }
+                    }
+                }
+            }
+
+            std::swap(prev, curr);
+        }
+    }
+
+    // resolve slab-local indices into the output
+    std::vector<int> offsets(slab_count + 1, 0);
+    for (int s = 0; s < slab_count; ++s) {
+        offsets[s + 1] = offsets[s] + (int)slabs[s].vertices.size();
+    }
+    std::vector<size_t> index_offsets(slab_count + 1, 0);
+    for (int s = 0; s < slab_count; ++s) {
+        index_offsets[s + 1] = index_offsets[s] + slabs[s].indices.size();
+    }
+
+    const int vertex_base = (int)vertices.size();
+    const size_t index_base = indices.size();
+    vertices.resize(vertices.size() + offsets[slab_count]);
+    indices.resize(indices.size() + index_offsets[slab_count]);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int s = 0; s < slab_count; ++s) {
+        const Slab& slab = slabs[s];
+        std::copy(
+                slab.vertices.begin(),
+                slab.vertices.end(),
+                vertices.begin() + vertex_base + offsets[s]);
+
+        const int local_base = vertex_base + offsets[s];
+        const int borrowed_base = s > 0 ?
+                vertex_base + offsets[s - 1] + slabs[s - 1].last_slice_start : 0;
+        for (size_t i = 0; i < slab.indices.size(); ++i) {
+            const int index = slab.indices[i];
+            indices[index_base + index_offsets[s] + i] = index >= 0 ?
+                    local_base + index : borrowed_base - index - 1;
+        }
+    }
+}
+
+} // namespace isosurface
+
+template <typename Discretizer, typename T>
+void ExtractIsosurface(
+    const VoxelGrid<Discretizer, T>& field,
+    double iso,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& indices)
+{
+    const int sx = field.sizeX();
+    const int sy = field.sizeY();
+    const int sz = field.sizeZ();
+    const T* data = field.data();
+    auto sample = [&](int x, int y, int z, double& f)
+    {
+        if (x < 0 || x >= sx || y < 0 || y >= sy || z < 0 || z >= sz) {
+            return false;
+        }
+        f = (double)data[(x * sy + y) * sz + z] - iso;
+        return true;
+    };
+
+    const WorldCoord wc(field.memoryToWorld(MemoryCoord(0, 0, 0)));
+    isosurface::ExtractSurfaceNet(
+            sx, sy, sz,
+            Eigen::Vector3d(wc.x, wc.y, wc.z),
+            field.res(),
+            sample,
+            vertices,
+            indices);
+}
+
+template <typename Discretizer>
+void ExtractOccupiedSurface(
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& indices)
+{
+    const int sx = vg.sizeX();
+    const int sy = vg.sizeY();
+    const int sz = vg.sizeZ();
+    const unsigned char* data = vg.data();
+    auto sample = [&](int x, int y, int z, double& f)
+    {
+        if (x < 0 || x >= sx || y < 0 || y >= sy || z < 0 || z >= sz) {
+            return false;
+        }
+        f = data[(x * sy + y) * sz + z] ? -1.0 : 1.0;
+        return true;
+    };
+
+    const WorldCoord wc(vg.memoryToWorld(MemoryCoord(0, 0, 0)));
+    isosurface::ExtractSurfaceNet(
+            sx, sy, sz,
+            Eigen::Vector3d(wc.x, wc.y, wc.z),
+            vg.res(),
+            sample,
+            vertices,
+            indices);
+}
+
+} // namespace sbpl
+
+#endif
@@ -30,7 +30,11 @@
 #ifndef sbpl_geometry_detail_mesh_utils_h
 #define sbpl_geometry_detail_mesh_utils_h
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
+#include <unordered_map>
+#include <utility>
 
 namespace sbpl {
 
@@ -168,6 +172,293 @@ void CreateGridMesh(
     }
 }
 
+/// \brief Collapse mesh vertices that share a grid cell into a single vertex
+///
+/// Based on the vertex clustering scheme described in:
+///
+/// 'Rossignac and Borrel, "Multi-resolution 3D approximations for rendering
+/// complex scenes," Modeling in Computer Graphics, 1993, pp. 455-465'
+///
+/// Each cluster is represented by the mean of its vertices, so no vertex moves
+/// further than the diagonal of one cell. Triangles that collapse to an edge
+/// or a point are dropped, as are duplicate triangles. Only vertices referenced
+/// by the remaining triangles are kept.
+///
+/// \param cell_of Callable mapping an Eigen::Vector3d to its GridCoord
+template <typename CellFunction>
+void ClusterMeshVertices(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const CellFunction& cell_of,
+    std::vector<Eigen::Vector3d>& simple_vertices,
+    std::vector<int>& simple_indices)
+{
+    // pack grid coordinates into 21 bits per axis to key the cluster map
+    auto cell_key = [](const GridCoord& gc) -> std::uint64_t
+    {
+        const std::uint64_t mask = (std::uint64_t(1) << 21) - 1;
+        const std::uint64_t bias = std::uint64_t(1) << 20;
+        return (((std::uint64_t)gc.x + bias) & mask) << 42 |
+               (((std::uint64_t)gc.y + bias) & mask) << 21 |
+               (((std::uint64_t)gc.z + bias) & mask);
+    };
+
+    // assign each referenced vertex to a cluster
+    std::unordered_map<std::uint64_t, int> cluster_ids;
+    std::vector<int> vertex_cluster(vertices.size(), -1);
+    std::vector<Eigen::Vector3d> cluster_sums;
+    std::vector<int> cluster_counts;
+    for (int index : indices) {
+        if (vertex_cluster[index] != -1) {
+            continue;
+        }
+        const Eigen::Vector3d& v = vertices[index];
+        const std::uint64_t key = cell_key(cell_of(v));
+        auto it = cluster_ids.find(key);
+        if (it == cluster_ids.end()) {
+            it = cluster_ids.insert(
+                    std::make_pair(key, (int)cluster_sums.size())).first;
+            cluster_sums.push_back(Eigen::Vector3d::Zero());
+            cluster_counts.push_back(0);
+        }
+        vertex_cluster[index] = it->second;
+        cluster_sums[it->second] += v;
+        ++cluster_counts[it->second];
+    }
+
+    // remap triangles onto clusters, dropping degenerate triangles and
+    // rotating each so that its smallest cluster index comes first
+    struct ClusterTriangle
+    {
+        int c[3];
+        bool operator<(const ClusterTriangle& o) const {
+            return std::lexicographical_compare(c, c + 3, o.c, o.c + 3);
+        }
+        bool operator==(const ClusterTriangle& o) const {
+            return c[0] == o.c[0] && c[1] == o.c[1] && c[2] == o.c[2];
+        }
+    };
+
+    std::vector<ClusterTriangle> triangles;
+    triangles.reserve(indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const int ca = vertex_cluster[indices[i + 0]];
+        const int cb = vertex_cluster[indices[i + 1]];
+        const int cc = vertex_cluster[indices[i + 2]];
+        if (ca == cb || cb == cc || cc == ca) {
+            continue;
+        }
+        ClusterTriangle t;
+        if (ca < cb && ca < cc) {
+            t.c[0] = ca; t.c[1] = cb; t.c[2] = cc;
+        }
+        else if (cb < cc) {
+            t.c[0] = cb; t.c[1] = cc; t.c[2] = ca;
+        }
+        else {
+            t.c[0] = cc; t.c[1] = ca; t.c[2] = cb;
+        }
+        triangles.push_back(t);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    triangles.erase(
+            std::unique(triangles.begin(), triangles.end()), triangles.end());
+
+    // emit only the clusters referenced by surviving triangles
+    std::vector<int> output_index(cluster_sums.size(), -1);
+    simple_indices.reserve(simple_indices.size() + 3 * triangles.size());
+    for (const ClusterTriangle& t : triangles) {
+        for (int j = 0; j < 3; ++j) {
+            const int c = t.c[j];
+            if (output_index[c] == -1) {
+                output_index[c] = (int)simple_vertices.size();
+                simple_vertices.push_back(
+                        cluster_sums[c] / (double)cluster_counts[c]);
+            }
+            simple_indices.push_back(output_index[c]);
+        }
+    }
+}
+
+template <typename Discretizer>
+void SimplifyMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& simple_vertices,
+    std::vector<int>& simple_indices)
+{
+    ClusterMeshVertices(
+            vertices,
+            indices,
+            [&](const Eigen::Vector3d& v)
+            {
+                return vg.worldToGrid(WorldCoord(v.x(), v.y(), v.z()));
+            },
+            simple_vertices,
+            simple_indices);
+}
+
+template <typename Discretizer>
+void CreateIndexedVoxelSurfaceMesh(
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& indices)
+{
+    // a rectangle on the plane normal to axis d at slice s, spanning
+    // [u0, u1] x [v0, v1] along the axes (d + 1) % 3 and (d + 2) % 3
+    struct Rect
+    {
+        int d, s, u0, v0, u1, v1;
+        bool positive;
+    };
+
+    const int size[3] = { vg.sizeX(), vg.sizeY(), vg.sizeZ() };
+
+    auto occupied = [&](int c[3])
+    {
+        if (c[0] < 0 || c[0] >= size[0] ||
+            c[1] < 0 || c[1] >= size[1] ||
+            c[2] < 0 || c[2] >= size[2])
+        {
+            return false;
+        }
+        return vg[MemoryCoord(c[0], c[1], c[2])] != 0;
+    };
+
+    // one task per slice plane along each axis
+    std::vector<std::pair<int, int>> slices;
+    for (int d = 0; d < 3; ++d) {
+        for (int s = 0; s <= size[d]; ++s) {
+            slices.push_back(std::make_pair(d, s));
+        }
+    }
+
+    std::vector<std::vector<Rect>> slice_rects(slices.size());
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int t = 0; t < (int)slices.size(); ++t) {
+        const int d = slices[t].first;
+        const int s = slices[t].second;
+        const int u = (d + 1) % 3;
+        const int v = (d + 2) % 3;
+        const int su = size[u];
+        const int sv = size[v];
+
+        // +1 for faces with normal along +d, -1 for faces along -d
+        std::vector<signed char> mask((size_t)su * sv, 0);
+        int c[3];
+        for (int j = 0; j < sv; ++j) {
+            for (int i = 0; i < su; ++i) {
+                c[u] = i;
+                c[v] = j;
+                c[d] = s - 1;
+                const bool behind = occupied(c);
+                c[d] = s;
+                const bool ahead = occupied(c);
+                if (behind != ahead) {
+                    mask[(size_t)j * su + i] = behind ? 1 : -1;
+                }
+            }
+        }
+
+        // greedily grow rectangles along u, then along v
+        for (int j = 0; j < sv; ++j) {
+            for (int i = 0; i < su; ) {
+                const signed char m = mask[(size_t)j * su + i];
+                if (m == 0) {
+                    ++i;
+                    continue;
+                }
+
+                int w = 1;
+                while (i + w < su && mask[(size_t)j * su + i + w] == m) {
+                    ++w;
+                }
+
+                int h = 1;
+                for (; j + h < sv; ++h) {
+                    bool full = true;
+                    for (int k = 0; k < w; ++k) {
+                        if (mask[(size_t)(j + h) * su + i + k] != m) {
+                            full = false;
+                            break;
+                        }
+                    }
+                    if (!full) {
+                        break;
+                    }
+                }
+
+                for (int l = 0; l < h; ++l) {
+                    std::fill(
+                            mask.begin() + (size_t)(j + l) * su + i,
+                            mask.begin() + (size_t)(j + l) * su + i + w,
+                            0);
+                }
+
+                Rect r = { d, s, i, j, i + w, j + h, m > 0 };
+                slice_rects[t].push_back(r);
+                i += w;
+            }
+        }
+    }
+
+    // emit rectangles, sharing vertices at lattice corners
+    std::unordered_map<std::int64_t, int> corner_vertices;
+    auto corner_index = [&](int c[3]) -> int
+    {
+        const std::int64_t key =
+                ((std::int64_t)c[0] * (size[1] + 1) + c[1]) * (size[2] + 1) + c[2];
+        auto it = corner_vertices.find(key);
+        if (it != corner_vertices.end()) {
+            return it->second;
+        }
+        const WorldCoord wc(vg.memoryToWorld(MemoryCoord(c[0], c[1], c[2])));
+        const int index = (int)vertices.size();
+        vertices.push_back(Eigen::Vector3d(wc.x, wc.y, wc.z) - 0.5 * vg.res());
+        corner_vertices[key] = index;
+        return index;
+    };
+
+    for (const std::vector<Rect>& rects : slice_rects) {
+        for (const Rect& r : rects) {
+            const int u = (r.d + 1) % 3;
+            const int v = (r.d + 2) % 3;
+            int c[3];
+            c[r.d] = r.s;
+            c[u] = r.u0; c[v] = r.v0;
+            const int p00 = corner_index(c);
+            c[u] = r.u1; c[v] = r.v0;
+            const int p10 = corner_index(c);
+            c[u] = r.u1; c[v] = r.v1;
+            const int p11 = corner_index(c);
+            c[u] = r.u0; c[v] = r.v1;
+            const int p01 = corner_index(c);
+
+            // (u, v, d) is right-handed, so u x v points along +d
+            if (r.positive) {
+                indices.push_back(p00);
+                indices.push_back(p10);
+                indices.push_back(p11);
+                indices.push_back(p00);
+                indices.push_back(p11);
+                indices.push_back(p01);
+            }
+            else {
+                indices.push_back(p00);
+                indices.push_back(p11);
+                indices.push_back(p10);
+                indices.push_back(p00);
+                indices.push_back(p01);
+                indices.push_back(p11);
+            }
+        }
+    }
+}
 
 } // namespace sbpl
 
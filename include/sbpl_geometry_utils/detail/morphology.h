@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_detail_morphology_h
+#define sbpl_geometry_detail_morphology_h
+
+namespace sbpl {
+
+/// \brief Dilate the occupied cells of a voxel grid by a structuring element
+///     of radius cells
+///
+/// Cells outside the grid are treated as empty. Occupied cells of the result
+/// are set to 1.
+template <typename Discretizer>
+void DilateVoxels(
+    VoxelGrid<Discretizer>& vg,
+    int radius,
+    StructuringElement element)
+{
+    PackedVoxelGrid packed;
+    PackVoxels(vg, packed);
+    DilateVoxels(packed, radius, element);
+    UnpackVoxels(packed, vg);
+}
+
+/// \brief Erode the occupied cells of a voxel grid by a structuring element
+///     of radius cells
+///
+/// Cells outside the grid do not contribute to the erosion. Occupied cells of
+/// the result are set to 1.
+template <typename Discretizer>
+void ErodeVoxels(
+    VoxelGrid<Discretizer>& vg,
+    int radius,
+    StructuringElement element)
+{
+    PackedVoxelGrid packed;
+    PackVoxels(vg, packed);
+    ErodeVoxels(packed, radius, element);
+    UnpackVoxels(packed, vg);
+}
+
+/// \brief Occupy every cell whose center lies within a Euclidean distance of
+///     radius of an occupied cell center
+///
+/// Distances are computed exactly with a separable distance transform, using
+/// the resolution of the grid along each axis.
+template <typename Discretizer>
+void DilateVoxelsEuclidean(VoxelGrid<Discretizer>& vg, double radius)
+{
+    PackedVoxelGrid packed;
+    PackVoxels(vg, packed);
+
+    std::vector<double> d2;
+    SquaredDistanceTransform(packed, vg.res(), d2);
+
+    const double r2 = radius * radius;
+    typename VoxelGrid<Discretizer>::value_type* data = vg.data();
+    for (size_t i = 0; i < d2.size(); ++i) {
+        data[i] = d2[i] <= r2;
+    }
+}
+
+/// \brief Clear every occupied cell whose center lies within a Euclidean
+///     distance of radius of an unoccupied cell center
+///
+/// Cells outside the grid do not contribute to the erosion.
+template <typename Discretizer>
+void ErodeVoxelsEuclidean(VoxelGrid<Discretizer>& vg, double radius)
+{
+    PackedVoxelGrid packed;
+    PackVoxels(vg, packed);
+    packed.flip();
+
+    std::vector<double> d2;
+    SquaredDistanceTransform(packed, vg.res(), d2);
+
+    const double r2 = radius * radius;
+    typename VoxelGrid<Discretizer>::value_type* data = vg.data();
+    for (size_t i = 0; i < d2.size(); ++i) {
+        data[i] = d2[i] > r2;
+    }
+}
+
+} // namespace sbpl
+
+#endif
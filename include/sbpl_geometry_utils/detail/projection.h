@@ -0,0 +1,223 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_detail_projection_h
+#define sbpl_geometry_detail_projection_h
+
+#include <string.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+namespace sbpl {
+namespace projection {
+
+// Return whether any of count cells is nonzero, eight cells at a time
+inline bool AnyOccupied(const unsigned char* cells, int count)
+{
+    std::uint64_t acc = 0;
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        std::uint64_t w;
+        memcpy(&w, cells + i, sizeof(w));
+        acc |= w;
+    }
+    for (; i < count; ++i) {
+        acc |= cells[i];
+    }
+    return acc != 0;
+}
+
+// Compute the range of z memory coordinates, [begin, end), of the cells
+// between the cells containing two heights, inclusive
+template <typename Discretizer, typename T>
+void ColumnRange(
+    const VoxelGrid<Discretizer, T>& vg,
+    double z_min,
+    double z_max,
+    int& begin,
+    int& end)
+{
+    const int lo = vg.zDiscretizer().discretize(z_min) - vg.minGridCoord().z;
+    const int hi = vg.zDiscretizer().discretize(z_max) - vg.minGridCoord().z;
+    begin = std::max(lo, 0);
+    end = std::max(begin, std::min(hi + 1, vg.sizeZ()));
+}
+
+// Reduce the [begin, end) segment of every z-column of a grid with a function
+// of the segment, writing the result to grid[sizeX * y + x]
+template <typename Discretizer, typename T, typename U, typename Reduce>
+void ProjectColumns(
+    const VoxelGrid<Discretizer, T>& vg,
+    int begin,
+    int end,
+    const Reduce& reduce,
+    U* grid)
+{
+    const int sx = vg.sizeX();
+    const int sy = vg.sizeY();
+    const int sz = vg.sizeZ();
+    const T* data = vg.data();
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < sx; ++x) {
+        for (int y = 0; y < sy; ++y) {
+            const T* column = data + ((size_t)x * sy + y) * sz;
+            grid[(size_t)sx * y + x] = reduce(column + begin, column + end);
+        }
+    }
+}
+
+} // namespace projection
+
+/// \brief Mark the cells of a 2D grid whose z-column contains an occupied
+///     cell between two heights
+///
+/// Cells of the 2D grid are set to 1 if occupied and 0 otherwise.
+template <typename Discretizer>
+void ProjectOccupancy(
+    const VoxelGrid<Discretizer>& vg,
+    double z_min,
+    double z_max,
+    unsigned char* grid)
+{
+    int begin, end;
+    projection::ColumnRange(vg, z_min, z_max, begin, end);
+    projection::ProjectColumns(
+            vg, begin, end,
+            [](const unsigned char* first, const unsigned char* last)
+            {
+                return (unsigned char)
+                        projection::AnyOccupied(first, (int)(last - first));
+            },
+            grid);
+}
+
+/// \brief Mark, as bits of each cell of a 2D grid, the height bands of its
+///     z-column that contain an occupied cell
+///
+/// Band i spans the cells from the one containing band_edges[i] up to, but not
+/// including, the one containing band_edges[i + 1], and sets bit i of the
+/// output. band_edges must be increasing and describe at most eight bands.
+template <typename Discretizer>
+bool ProjectOccupancyBands(
+    const VoxelGrid<Discretizer>& vg,
+    const std::vector<double>& band_edges,
+    unsigned char* grid)
+{
+    const int band_count = (int)band_edges.size() - 1;
+    if (band_count < 1 || band_count > 8) {
+        std::cerr << "Height bands must number between 1 and 8" << std::endl;
+        return false;
+    }
+
+    // the z memory coordinates at which each band begins, with the last
+    // entry marking the end of the last band
+    std::vector<int> bounds(band_edges.size());
+    for (size_t i = 0; i < band_edges.size(); ++i) {
+        const int gz = vg.zDiscretizer().discretize(band_edges[i]);
+        bounds[i] = std::min(
+                std::max(gz - vg.minGridCoord().z, 0), vg.sizeZ());
+        if (i > 0 && bounds[i] < bounds[i - 1]) {
+            std::cerr << "Height band edges must be increasing" << std::endl;
+            return false;
+        }
+    }
+
+    projection::ProjectColumns(
+            vg, 0, vg.sizeZ(),
+            [&](const unsigned char* column, const unsigned char*)
+            {
+                unsigned char bits = 0;
+                for (int i = 0; i < band_count; ++i) {
+                    if (projection::AnyOccupied(
+                            column + bounds[i], bounds[i + 1] - bounds[i]))
+                    {
+                        bits |= (unsigned char)(1 << i);
+                    }
+                }
+                return bits;
+            },
+            grid);
+    return true;
+}
+
+/// \brief Store the maximum value in each z-column between two heights in the
+///     cells of a 2D grid
+///
+/// Columns with no cells between the heights are reduced to T().
+template <typename Discretizer, typename T>
+void ProjectMax(
+    const VoxelGrid<Discretizer, T>& vg,
+    double z_min,
+    double z_max,
+    T* grid)
+{
+    int begin, end;
+    projection::ColumnRange(vg, z_min, z_max, begin, end);
+    projection::ProjectColumns(
+            vg, begin, end,
+            [](const T* first, const T* last)
+            {
+                return first == last ? T() : *std::max_element(first, last);
+            },
+            grid);
+}
+
+/// \brief Store the minimum value in each z-column between two heights in the
+///     cells of a 2D grid
+///
+/// Columns with no cells between the heights are reduced to the maximum value
+/// of T.
+template <typename Discretizer, typename T>
+void ProjectMin(
+    const VoxelGrid<Discretizer, T>& vg,
+    double z_min,
+    double z_max,
+    T* grid)
+{
+    int begin, end;
+    projection::ColumnRange(vg, z_min, z_max, begin, end);
+    projection::ProjectColumns(
+            vg, begin, end,
+            [](const T* first, const T* last)
+            {
+                return first == last ?
+                        std::numeric_limits<T>::max() :
+                        *std::min_element(first, last);
+            },
+            grid);
+}
+
+} // namespace sbpl
+
+#endif
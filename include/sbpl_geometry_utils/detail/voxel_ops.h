@@ -0,0 +1,339 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_detail_voxel_ops_h
+#define sbpl_geometry_detail_voxel_ops_h
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+namespace sbpl {
+namespace voxel_ops {
+
+// Map each nonzero byte of a word to 0x01 and each zero byte to 0x00
+inline std::uint64_t NormalizeBytes(std::uint64_t w)
+{
+    const std::uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+    return ((((w & low7) + low7) | w) & ~low7) >> 7;
+}
+
+struct Union
+{
+    static const bool clear_outside = false;
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) { return a | b; }
+};
+
+struct Intersect
+{
+    static const bool clear_outside = true;
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) { return a & b; }
+};
+
+struct Subtract
+{
+    static const bool clear_outside = false;
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) { return a & ~b; }
+};
+
+struct Xor
+{
+    static const bool clear_outside = false;
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) { return a ^ b; }
+};
+
+// Combine a row of count cells of b into a, eight cells at a time
+template <typename Op>
+void CombineRow(unsigned char* a, const unsigned char* b, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        std::uint64_t wa;
+        std::uint64_t wb;
+        memcpy(&wa, a + i, sizeof(wa));
+        memcpy(&wb, b + i, sizeof(wb));
+        wa = Op::apply(NormalizeBytes(wa), NormalizeBytes(wb));
+        memcpy(a + i, &wa, sizeof(wa));
+    }
+    for (; i < count; ++i) {
+        a[i] = (unsigned char)Op::apply(a[i] != 0, b[i] != 0);
+    }
+}
+
+// Return a pointer to the z-row at (x, y), starting at the grid's minimum z
+template <typename Discretizer>
+unsigned char* RowAt(VoxelGrid<Discretizer>& g, int x, int y)
+{
+    return g.data() + g.gridToIndex(GridCoord(x, y, g.minGridCoord().z)).idx;
+}
+
+template <typename Discretizer>
+const unsigned char* RowAt(const VoxelGrid<Discretizer>& g, int x, int y)
+{
+    return g.data() + g.gridToIndex(GridCoord(x, y, g.minGridCoord().z)).idx;
+}
+
+template <typename Discretizer, typename T>
+T* RowAt(const VoxelGridView<Discretizer, T>& v, int x, int y)
+{
+    return v.row(x - v.minGridCoord().x, y - v.minGridCoord().y);
+}
+
+template <typename GridA, typename GridB>
+bool LatticesMatch(const GridA& a, const GridB& b)
+{
+    const double eps = 1.0e-6;
+    if (((a.res() - b.res()).array().abs() > eps * a.res().array()).any()) {
+        return false;
+    }
+
+    const GridCoord gc = a.minGridCoord();
+    const WorldCoord wa = a.gridToWorld(gc);
+    const WorldCoord wb = b.gridToWorld(gc);
+    return fabs(wa.x - wb.x) <= eps * a.res().x() &&
+            fabs(wa.y - wb.y) <= eps * a.res().y() &&
+            fabs(wa.z - wb.z) <= eps * a.res().z();
+}
+
+// Apply a boolean operation to the region of a overlapped by b, one z-row at
+// a time, distributing x-slabs across threads. Cells of a outside the overlap
+// are combined with empty cells of b, which only affects intersection. Either
+// grid may be a VoxelGrid or a VoxelGridView.
+template <typename Op, typename GridA, typename GridB>
+bool Combine(GridA& a, const GridB& b)
+{
+    if (!LatticesMatch(a, b)) {
+        std::cerr << "Voxel grids do not share the same lattice" << std::endl;
+        return false;
+    }
+
+    const GridCoord amin = a.minGridCoord();
+    const GridCoord amax = a.maxGridCoord();
+    const GridCoord bmin = b.minGridCoord();
+    const GridCoord bmax = b.maxGridCoord();
+    const GridCoord omin(
+            std::max(amin.x, bmin.x),
+            std::max(amin.y, bmin.y),
+            std::max(amin.z, bmin.z));
+    const GridCoord omax(
+            std::min(amax.x, bmax.x),
+            std::min(amax.y, bmax.y),
+            std::min(amax.z, bmax.z));
+
+    const bool overlap = omin.x <= omax.x && omin.y <= omax.y && omin.z <= omax.z;
+    if (!overlap) {
+        if (Op::clear_outside) {
+            a.assign(0);
+        }
+        return true;
+    }
+
+    const int count = omax.z - omin.z + 1;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = amin.x; x <= amax.x; ++x) {
+        for (int y = amin.y; y <= amax.y; ++y) {
+            unsigned char* arow = RowAt(a, x, y);
+            if (x < omin.x || x > omax.x || y < omin.y || y > omax.y) {
+                if (Op::clear_outside) {
+                    memset(arow, 0, a.sizeZ());
+                }
+                continue;
+            }
+
+            if (Op::clear_outside) {
+                memset(arow, 0, omin.z - amin.z);
+                memset(arow + (omax.z - amin.z) + 1, 0, amax.z - omax.z);
+            }
+
+            const unsigned char* brow = RowAt(b, x, y) + (omin.z - bmin.z);
+            CombineRow<Op>(arow + (omin.z - amin.z), brow, count);
+        }
+    }
+
+    return true;
+}
+
+} // namespace voxel_ops
+
+/// \brief Store the union of two voxel grids in the first
+///
+/// The grids must share the same lattice but may have different extents;
+/// cells outside the extents of b are treated as empty and the corresponding
+/// cells of a are left unchanged. Cells within the overlap are set to 0 or 1.
+template <typename Discretizer>
+bool UnionVoxels(VoxelGrid<Discretizer>& a, const VoxelGrid<Discretizer>& b)
+{
+    return voxel_ops::Combine<voxel_ops::Union>(a, b);
+}
+
+/// \brief Store the intersection of two voxel grids in the first
+///
+/// The grids must share the same lattice but may have different extents;
+/// cells outside the extents of b are treated as empty and the corresponding
+/// cells of a are cleared. Cells within the overlap are set to 0 or 1.
+template <typename Discretizer>
+bool IntersectVoxels(VoxelGrid<Discretizer>& a, const VoxelGrid<Discretizer>& b)
+{
+    return voxel_ops::Combine<voxel_ops::Intersect>(a, b);
+}
+
+/// \brief Remove the cells occupied in the second voxel grid from the first
+///
+/// The grids must share the same lattice but may have different extents;
+/// cells outside the extents of b are treated as empty and the corresponding
+/// cells of a are left unchanged. Cells within the overlap are set to 0 or 1.
+template <typename Discretizer>
+bool SubtractVoxels(VoxelGrid<Discretizer>& a, const VoxelGrid<Discretizer>& b)
+{
+    return voxel_ops::Combine<voxel_ops::Subtract>(a, b);
+}
+
+/// \brief Store the symmetric difference of two voxel grids in the first
+///
+/// The grids must share the same lattice but may have different extents;
+/// cells outside the extents of b are treated as empty and the corresponding
+/// cells of a are left unchanged. Cells within the overlap are set to 0 or 1.
+template <typename Discretizer>
+bool XorVoxels(VoxelGrid<Discretizer>& a, const VoxelGrid<Discretizer>& b)
+{
+    return voxel_ops::Combine<voxel_ops::Xor>(a, b);
+}
+
+/// \brief Store the union of two views in the first
+///
+/// Only the cells of the view a are modified; cells of a outside of b are
+/// treated as described for the corresponding grid operation.
+template <typename Discretizer, typename T>
+bool UnionVoxels(
+    VoxelGridView<Discretizer> a,
+    const VoxelGridView<Discretizer, T>& b)
+{
+    return voxel_ops::Combine<voxel_ops::Union>(a, b);
+}
+
+/// \brief Store the intersection of two views in the first
+///
+/// Only the cells of the view a are modified; cells of a outside of b are
+/// treated as described for the corresponding grid operation.
+template <typename Discretizer, typename T>
+bool IntersectVoxels(
+    VoxelGridView<Discretizer> a,
+    const VoxelGridView<Discretizer, T>& b)
+{
+    return voxel_ops::Combine<voxel_ops::Intersect>(a, b);
+}
+
+/// \brief Remove the cells occupied in the second view from the first
+///
+/// Only the cells of the view a are modified; cells of a outside of b are
+/// treated as described for the corresponding grid operation.
+template <typename Discretizer, typename T>
+bool SubtractVoxels(
+    VoxelGridView<Discretizer> a,
+    const VoxelGridView<Discretizer, T>& b)
+{
+    return voxel_ops::Combine<voxel_ops::Subtract>(a, b);
+}
+
+/// \brief Store the symmetric difference of two views in the first
+///
+/// Only the cells of the view a are modified; cells of a outside of b are
+/// treated as described for the corresponding grid operation.
+template <typename Discretizer, typename T>
+bool XorVoxels(
+    VoxelGridView<Discretizer> a,
+    const VoxelGridView<Discretizer, T>& b)
+{
+    return voxel_ops::Combine<voxel_ops::Xor>(a, b);
+}
+
+/// \brief Store the union of two voxel grids, over the extents of a, in c
+template <typename Discretizer>
+bool UnionVoxels(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b,
+    VoxelGrid<Discretizer>& c)
+{
+    c = a;
+    return UnionVoxels(c, b);
+}
+
+/// \brief Store the intersection of two voxel grids, over the extents of a, in
+///     c
+template <typename Discretizer>
+bool IntersectVoxels(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b,
+    VoxelGrid<Discretizer>& c)
+{
+    c = a;
+    return IntersectVoxels(c, b);
+}
+
+/// \brief Store the cells of a not occupied in b, over the extents of a, in c
+template <typename Discretizer>
+bool SubtractVoxels(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b,
+    VoxelGrid<Discretizer>& c)
+{
+    c = a;
+    return SubtractVoxels(c, b);
+}
+
+/// \brief Store the symmetric difference of two voxel grids, over the extents
+///     of a, in c
+template <typename Discretizer>
+bool XorVoxels(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b,
+    VoxelGrid<Discretizer>& c)
+{
+    c = a;
+    return XorVoxels(c, b);
+}
+
+/// \brief Return whether two voxel grids share the same resolution and cell
+///     boundaries
+template <typename Discretizer>
+bool SameLattice(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b)
+{
+    return voxel_ops::LatticesMatch(a, b);
+}
+
+} // namespace sbpl
+
+#endif
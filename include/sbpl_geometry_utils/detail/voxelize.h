@@ -30,8 +30,61 @@
 #ifndef sbpl_geometry_detail_voxelize_h
 #define sbpl_geometry_detail_voxelize_h
 
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include <sbpl_geometry_utils/intersect.h>
+
 namespace sbpl {
 
+// Return whether a triangle, with vertices given relative to the center of an
+// axis-aligned box, overlaps the box. The triangle and box are tested for a
+// separating axis among the box axes, the triangle normal, and the cross
+// products of the box axes with the triangle edges. Touching counts as
+// overlapping.
+inline bool TriangleOverlapsBox(
+    const Eigen::Vector3d& v0,
+    const Eigen::Vector3d& v1,
+    const Eigen::Vector3d& v2,
+    const Eigen::Vector3d& n,
+    const Eigen::Vector3d& half)
+{
+    for (int i = 0; i < 3; ++i) {
+        if (std::min(std::min(v0[i], v1[i]), v2[i]) > half[i] ||
+            std::max(std::max(v0[i], v1[i]), v2[i]) < -half[i])
+        {
+            return false;
+        }
+    }
+
+    if (std::fabs(n.dot(v0)) > half.dot(n.cwiseAbs())) {
+        return false;
+    }
+
+    const Eigen::Vector3d edges[3] = { v1 - v0, v2 - v1, v0 - v2 };
+    for (const Eigen::Vector3d& f : edges) {
+        for (int i = 0; i < 3; ++i) {
+            const Eigen::Vector3d axis = Eigen::Vector3d::Unit(i).cross(f);
+            const double p0 = axis.dot(v0);
+            const double p1 = axis.dot(v1);
+            const double p2 = axis.dot(v2);
+            const double r = half.dot(axis.cwiseAbs());
+            if (std::min(std::min(p0, p1), p2) > r ||
+                std::max(std::max(p0, p1), p2) < -r)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 /// \brief Voxelize a triangle
 ///
 /// Based on the algorithm described in:
@@ -39,13 +92,77 @@ namespace sbpl {
 /// 'Huang, Yagel, Filippov, and Kurzion, "An Accurate Method for Voxelizing
 /// Polygon Meshes," IEEE Volume Visualization '98, October, 1998, Chapel Hill,
 /// North Carolina, USA, pp. 119-126'
-template <typename Discretizer>
+///
+/// A cell is filled if its center lies within a sphere about a vertex, a
+/// cylinder about an edge, or a slab about the face of the triangle. For
+/// 26-separating surfaces, the radius of the spheres and cylinders is that of
+/// the sphere circumscribing a cell and the slab is as thick as the extent of
+/// a cell along the triangle normal. For 6-separating surfaces, the radius is
+/// that of the inscribed sphere and the slab is as thick as the extent of a
+/// cell along the principal axis nearest the normal. Conservative surfaces
+/// instead fill exactly the cells whose boxes overlap the triangle, as found
+/// by a separating axis test.
+///
+/// \tparam Grid A voxel grid type such as VoxelGrid or BrickVoxelGrid that
+///     provides res(), worldToGrid(), gridToWorld(), and operator[] taking a
+///     GridCoord. Cells are read through the const operator[] so that sparse
+///     grids only allocate storage for cells that are written.
+template <typename Grid>
 void VoxelizeTriangle(
     const Eigen::Vector3d& a,
     const Eigen::Vector3d& b,
     const Eigen::Vector3d& c,
-    VoxelGrid<Discretizer>& vg)
+    Grid& vg,
+    Separability sep)
 {
+    const int lo = std::numeric_limits<int>::min();
+    const int hi = std::numeric_limits<int>::max();
+    VoxelizeTriangle(
+            a, b, c, GridCoord(lo, lo, lo), GridCoord(hi, hi, hi), vg, sep);
+}
+
+/// \brief Voxelize the part of a triangle that lies within a region of a grid
+///
+/// Only cells with grid coordinates between roi_min and roi_max, inclusive,
+/// are considered, and triangles whose bounding box does not overlap the
+/// region are rejected before any other work is done.
+template <typename Grid>
+void VoxelizeTriangle(
+    const Eigen::Vector3d& a,
+    const Eigen::Vector3d& b,
+    const Eigen::Vector3d& c,
+    const GridCoord& roi_min,
+    const GridCoord& roi_max,
+    Grid& vg,
+    Separability sep)
+{
+    Eigen::Vector3d mintri;
+    Eigen::Vector3d maxtri;
+    ComputeAxisAlignedBoundingBox({ a, b, c }, mintri, maxtri);
+
+    // tolerance for cell centers that lie exactly on a slab or edge boundary,
+    // as they do when the triangle lies on cell boundaries. The cells on
+    // either side of such a boundary are both considered.
+    const Eigen::Vector3d half_res = 0.5 * vg.res();
+    const double eps = 1e-6 * half_res.minCoeff();
+    mintri.array() -= eps;
+    maxtri.array() += eps;
+
+    const WorldCoord minwc(mintri.x(), mintri.y(), mintri.z());
+    const WorldCoord maxwc(maxtri.x(), maxtri.y(), maxtri.z());
+    GridCoord mingc = vg.worldToGrid(minwc);
+    GridCoord maxgc = vg.worldToGrid(maxwc);
+
+    mingc.x = std::max(mingc.x, roi_min.x);
+    mingc.y = std::max(mingc.y, roi_min.y);
+    mingc.z = std::max(mingc.z, roi_min.z);
+    maxgc.x = std::min(maxgc.x, roi_max.x);
+    maxgc.y = std::min(maxgc.y, roi_max.y);
+    maxgc.z = std::min(maxgc.z, roi_max.z);
+    if (mingc.x > maxgc.x || mingc.y > maxgc.y || mingc.z > maxgc.z) {
+        return;
+    }
+
     Eigen::Vector3d p1 = a;
     Eigen::Vector3d p2 = b;
     Eigen::Vector3d p3 = c;
@@ -61,12 +178,6 @@ void VoxelizeTriangle(
         std::swap(p1, p3);
     }
 
-    // thickness parameters
-
-    double rc = sqrt(3.0) * 0.5 * vg.res().x();
-//    double rc = sqrt(3.0) * 0.5 * vg.res().x();
-    double rc2 = rc * rc;
-
     // get the normal vector for the triangle
     Eigen::Vector3d u = p2 - p1;
     Eigen::Vector3d v = p3 - p2;
@@ -74,20 +185,46 @@ void VoxelizeTriangle(
     Eigen::Vector3d n = u.cross(v);
     n.normalize();
 
-    double ca = 1.0;
-    double corners[] = {
-        Eigen::Vector3d(-0.5774, -0.5774, -0.5774).dot(n),
-        Eigen::Vector3d(-0.5774, -0.5774,  0.5774).dot(n),
-        Eigen::Vector3d(-0.5774,  0.5774, -0.5774).dot(n),
-        Eigen::Vector3d(-0.5774,  0.5774,  0.5774).dot(n),
-        Eigen::Vector3d( 0.5774, -0.5774, -0.5774).dot(n),
-        Eigen::Vector3d( 0.5774, -0.5774,  0.5774).dot(n),
-        Eigen::Vector3d( 0.5774,  0.5774, -0.5774).dot(n),
-        Eigen::Vector3d( 0.5774,  0.5774,  0.5774).dot(n)
-    };
-    ca = *std::max_element(corners, corners + sizeof(corners));
+    const Grid& cvg = vg;
 
-    double t = rc * ca;
+    if (sep == Separability::Conservative) {
+        const Eigen::Vector3d half = 0.5 * vg.res();
+        for (int gx = mingc.x; gx <= maxgc.x; gx++) {
+            for (int gy = mingc.y; gy <= maxgc.y; gy++) {
+                for (int gz = mingc.z; gz <= maxgc.z; gz++) {
+                    const GridCoord gc(gx, gy, gz);
+                    if (cvg[gc]) {
+                        continue;
+                    }
+                    const WorldCoord wc = vg.gridToWorld(gc);
+                    const Eigen::Vector3d center(wc.x, wc.y, wc.z);
+                    if (TriangleOverlapsBox(
+                            p1 - center, p2 - center, p3 - center, n, half))
+                    {
+                        vg[gc] = 1;
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // thickness parameters, measured per axis so that anisotropic cells are
+    // covered along every axis. t is the half-thickness of the slab about the
+    // triangle plane: the half-extent of a cell along the normal's dominant
+    // axis for Six, and along the normal itself for TwentySix.
+    const Eigen::Vector3d ext = n.cwiseAbs().cwiseProduct(half_res);
+    double rc;
+    double t;
+    if (sep == Separability::Six) {
+        rc = half_res.minCoeff();
+        t = ext.maxCoeff();
+    }
+    else {
+        rc = half_res.norm();
+        t = ext.sum();
+    }
+    double rc2 = rc * rc;
 
     // get the distance from the origin for the triangle plane
     double d = -n.dot(p1);
@@ -109,21 +246,12 @@ void VoxelizeTriangle(
     double d2 = -e2.dot(p2);
     double d3 = -e3.dot(p3);
 
-    Eigen::Vector3d mintri;
-    Eigen::Vector3d maxtri;
-    ComputeAxisAlignedBoundingBox({ a, b, c }, mintri, maxtri);
-
-    const WorldCoord minwc(mintri.x(), mintri.y(), mintri.z());
-    const WorldCoord maxwc(maxtri.x(), maxtri.y(), maxtri.z());
-    const GridCoord mingc = vg.worldToGrid(minwc);
-    const GridCoord maxgc = vg.worldToGrid(maxwc);
-
     // consider all voxels that this triangle can voxelize
     for (int gx = mingc.x; gx <= maxgc.x; gx++) {
         for (int gy = mingc.y; gy <= maxgc.y; gy++) {
             for (int gz = mingc.z; gz <= maxgc.z; gz++) {
                 const GridCoord gc(gx, gy, gz);
-                if (vg[gc]) {
+                if (cvg[gc]) {
                     continue;
                 }
 
@@ -146,7 +274,7 @@ void VoxelizeTriangle(
                     // vertex fills this voxel
                     vg[gc] = 1;
                 }
-                else if (Distance(p1, p3, rc2, voxel_p) != -1.0 ||
+                else if (Distance(p1, p2, rc2, voxel_p) != -1.0 ||
                          Distance(p2, p3, rc2, voxel_p) != -1.0 ||
                          Distance(p3, p1, rc2, voxel_p) != -1.0)
                 {
@@ -155,18 +283,14 @@ void VoxelizeTriangle(
                 }
                 else {
                     // then check for inside the triangle
-                    if ((
-                            // inside triangle thickness
-                            utils::Signd(n.dot(voxel_p) + (d + t)) != utils::Signd(n.dot(voxel_p) + (d - t))
-                        ) &&
-                        (
-                            // inside the edge bounding planes
-                            (
-                                (e1.dot(voxel_p) + d1 > 0.0) &&
-                                (e2.dot(voxel_p) + d2 > 0.0) &&
-                                (e3.dot(voxel_p) + d3 > 0.0)
-                            )
-                        ))
+                    // inside or on the triangle thickness and the edge
+                    // bounding planes, so that cells on the boundary of the
+                    // slab, or on an edge shared by two triangles, are kept
+                    // regardless of the winding of the triangles
+                    if (fabs(n.dot(voxel_p) + d) <= t + eps &&
+                        e1.dot(voxel_p) + d1 >= -eps &&
+                        e2.dot(voxel_p) + d2 >= -eps &&
+                        e3.dot(voxel_p) + d3 >= -eps)
                     {
                         vg[gc] = 1;
                     }
@@ -176,6 +300,919 @@ void VoxelizeTriangle(
     }
 }
 
+/// \brief Voxelize a mesh into an existing voxel grid
+///
+/// Only the parts of the mesh within the grid are voxelized. When filling, the
+/// grid should contain the mesh's full extent along z, the scan direction, so
+/// that the scan starts outside the mesh.
+template <typename Discretizer>
+void VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    VoxelGrid<Discretizer>& vg,
+    bool fill,
+    Separability sep)
+{
+    for (int i = 0; i < (int)indices.size() / 3; i++) {
+        const Eigen::Vector3d& a = vertices[indices[3 * i + 0]];
+        const Eigen::Vector3d& b = vertices[indices[3 * i + 1]];
+        const Eigen::Vector3d& c = vertices[indices[3 * i + 2]];
+        VoxelizeTriangle(
+                a, b, c, vg.minGridCoord(), vg.maxGridCoord(), vg, sep);
+    }
+
+    if (fill) {
+        ScanFill(vg);
+    }
+}
+
+/// \brief Voxelize a mesh into a view of a voxel grid
+///
+/// Only the cells of the view are written. As with a grid, when filling, the
+/// view should contain the mesh's full extent along z.
+template <typename Discretizer>
+void VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    VoxelGridView<Discretizer> view,
+    bool fill,
+    Separability sep)
+{
+    if (view.empty()) {
+        return;
+    }
+
+    for (int i = 0; i < (int)indices.size() / 3; i++) {
+        const Eigen::Vector3d& a = vertices[indices[3 * i + 0]];
+        const Eigen::Vector3d& b = vertices[indices[3 * i + 1]];
+        const Eigen::Vector3d& c = vertices[indices[3 * i + 2]];
+        VoxelizeTriangle(
+                a, b, c, view.minGridCoord(), view.maxGridCoord(), view, sep);
+    }
+
+    if (fill) {
+        ScanFill(view);
+    }
+}
+
+/// \brief Voxelize a mesh into an existing voxel grid through a write policy
+///
+/// The mesh is first voxelized into an occupancy grid covering its bounding
+/// box, and the write policy is then applied once to each corresponding cell
+/// of vg, so that each mesh contributes at most one write to any cell. This
+/// allows multiple objects to be labeled, counted, or costed in a single grid.
+/// Cells that fall outside of vg are ignored.
+///
+/// Since vg is only touched through the write policy, multiple meshes may be
+/// voxelized into the same grid from concurrent threads, without locking, by
+/// using one of the atomic write policies.
+///
+/// \tparam WritePolicy A function object callable as write(T& cell), such as
+///     SetFlag, WriteLabel, SaturatingIncrement, or MinCost, or for concurrent
+///     writers AtomicSetFlag, AtomicMaxLabel, AtomicSaturatingIncrement, or
+///     AtomicMinCost
+template <typename Discretizer, typename T, typename WritePolicy>
+void VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    VoxelGrid<Discretizer, T>& vg,
+    const WritePolicy& write,
+    bool fill,
+    Separability sep)
+{
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+    if (!ComputeAxisAlignedBoundingBox(vertices, min, max)) {
+        return;
+    }
+
+    VoxelGrid<Discretizer> occ(
+            min, max - min, vg.res(),
+            vg.xDiscretizer(), vg.yDiscretizer(), vg.zDiscretizer());
+    VoxelizeMesh(vertices, indices, occ, fill, sep);
+
+    for (int x = 0; x < occ.sizeX(); x++) {
+        for (int y = 0; y < occ.sizeY(); y++) {
+            for (int z = 0; z < occ.sizeZ(); z++) {
+                const MemoryCoord mc(x, y, z);
+                if (!occ[mc]) {
+                    continue;
+                }
+                const GridCoord gc = occ.memoryToGrid(mc);
+                if (vg.isInBounds(gc)) {
+                    write(vg[gc]);
+                }
+            }
+        }
+    }
+}
+
+/// \brief Voxelize the triangles produced by a streaming reader
+///
+/// Triangles are read and voxelized chunk_size at a time so that the mesh never
+/// needs to be resident in memory. Paired with a BrickVoxelGrid, memory use is
+/// bounded by the chunk size and the number of bricks the surface touches.
+/// Since the grid is never complete until the stream is exhausted, filling the
+/// interior is left to the caller.
+///
+/// \tparam TriangleReader A reader such as StlReader or ObjReader providing
+///     size_t read(size_t max_count, std::vector<Triangle>& triangles)
+/// \param sep The separability of the voxelized surface, as in
+///     VoxelizeTriangle
+/// \return The number of triangles voxelized
+template <typename TriangleReader, typename Grid>
+size_t VoxelizeStream(
+    TriangleReader& reader,
+    Grid& vg,
+    size_t chunk_size,
+    Separability sep)
+{
+    std::vector<Triangle> triangles;
+    triangles.reserve(chunk_size);
+    size_t total = 0;
+    while (true) {
+        triangles.clear();
+        const size_t count = reader.read(chunk_size, triangles);
+        if (count == 0) {
+            break;
+        }
+        for (const Triangle& tr : triangles) {
+            VoxelizeTriangle(tr.a, tr.b, tr.c, vg, sep);
+        }
+        total += count;
+    }
+    return total;
+}
+
+/// \brief Voxelize a closed mesh and compute its narrow-band signed distance
+///     field
+///
+/// The mesh is voxelized and filled into the voxel grid, and distances is reset
+/// to a float grid with the same extents and discretization. For every cell
+/// within band cells of a triangle, along the coarsest axis of the grid, the
+/// distance from the cell center to the closest triangle is written to the
+/// corresponding cell of distances. Cells outside the band are assigned band
+/// times the largest resolution. Distances are negative inside the mesh, as
+/// determined by the fill. Cells on the surface take their sign from the side
+/// of the closest triangle they lie on. Each triangle is oriented by probing
+/// the filled grid just beyond the surface layer on both of its sides, falling
+/// back to counterclockwise winding when the probes are inconclusive.
+///
+/// The voxel grid must be large enough to contain the mesh and its band.
+template <typename Discretizer>
+void VoxelizeMeshDistance(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    int band,
+    VoxelGrid<Discretizer>& vg,
+    VoxelGrid<Discretizer, float>& distances)
+{
+    const int cell_count = vg.sizeX() * vg.sizeY() * vg.sizeZ();
+    const double max_dist = band * vg.res().maxCoeff();
+    distances = VoxelGrid<Discretizer, float>(
+            vg.origin(), vg.size(), vg.res(),
+            vg.xDiscretizer(), vg.yDiscretizer(), vg.zDiscretizer());
+    distances.assign((float)max_dist);
+
+    // keep the surface voxels around to sign the distances of surface cells
+    VoxelizeMesh(vertices, indices, vg, false);
+    std::vector<bool> surface(cell_count);
+    for (int i = 0; i < cell_count; ++i) {
+        surface[i] = vg[MemoryIndex(i)] != 0;
+    }
+    ScanFill(vg);
+
+    // -1 for surface or out-of-bounds cells, 1 for inside cells, 0 otherwise
+    auto probe = [&](const Eigen::Vector3d& p)
+    {
+        const MemoryCoord mc = vg.worldToMemory(WorldCoord(p.x(), p.y(), p.z()));
+        if (mc.x < 0 || mc.x >= vg.sizeX() ||
+            mc.y < 0 || mc.y >= vg.sizeY() ||
+            mc.z < 0 || mc.z >= vg.sizeZ())
+        {
+            return -1;
+        }
+        const int idx = vg.memoryToIndex(mc).idx;
+        if (surface[idx]) {
+            return -1;
+        }
+        return vg[MemoryIndex(idx)] ? 1 : 0;
+    };
+
+    const double probe_dist = 1.5 * vg.res().maxCoeff();
+    for (int i = 0; i < (int)indices.size() / 3; i++) {
+        const Triangle tr(
+                vertices[indices[3 * i + 0]],
+                vertices[indices[3 * i + 1]],
+                vertices[indices[3 * i + 2]]);
+        Eigen::Vector3d n = (tr.b - tr.a).cross(tr.c - tr.a);
+        if (n.squaredNorm() == 0.0) {
+            continue;
+        }
+
+        const Eigen::Vector3d centroid = (tr.a + tr.b + tr.c) / 3.0;
+        const Eigen::Vector3d offset = probe_dist * n.normalized();
+        if (probe(centroid + offset) == 1 && probe(centroid - offset) == 0) {
+            n = -n;
+        }
+
+        Eigen::Vector3d mintri;
+        Eigen::Vector3d maxtri;
+        ComputeAxisAlignedBoundingBox({ tr.a, tr.b, tr.c }, mintri, maxtri);
+        mintri -= Eigen::Vector3d::Constant(max_dist);
+        maxtri += Eigen::Vector3d::Constant(max_dist);
+
+        MemoryCoord minmc = vg.worldToMemory(WorldCoord(mintri.x(), mintri.y(), mintri.z()));
+        MemoryCoord maxmc = vg.worldToMemory(WorldCoord(maxtri.x(), maxtri.y(), maxtri.z()));
+        minmc.x = std::max(minmc.x, 0);
+        minmc.y = std::max(minmc.y, 0);
+        minmc.z = std::max(minmc.z, 0);
+        maxmc.x = std::min(maxmc.x, vg.sizeX() - 1);
+        maxmc.y = std::min(maxmc.y, vg.sizeY() - 1);
+        maxmc.z = std::min(maxmc.z, vg.sizeZ() - 1);
+
+        for (int x = minmc.x; x <= maxmc.x; ++x) {
+            for (int y = minmc.y; y <= maxmc.y; ++y) {
+                for (int z = minmc.z; z <= maxmc.z; ++z) {
+                    const MemoryCoord mc(x, y, z);
+                    const int idx = vg.memoryToIndex(mc).idx;
+                    const WorldCoord wc = vg.memoryToWorld(mc);
+                    const Eigen::Vector3d p(wc.x, wc.y, wc.z);
+                    const Eigen::Vector3d q = ClosestPointOnTriangle(p, tr);
+                    const double d = (p - q).norm();
+                    float& dist = distances[MemoryIndex(idx)];
+                    if (d < fabs(dist)) {
+                        const bool inside = surface[idx] ?
+                                n.dot(p - tr.a) < 0.0 : vg[MemoryIndex(idx)] != 0;
+                        dist = (float)(inside ? -d : d);
+                    }
+                }
+            }
+        }
+    }
+
+    // sign the cells that no triangle's band reached
+    float* dist = distances.data();
+    for (int i = 0; i < cell_count; ++i) {
+        if (vg[MemoryIndex(i)] && !surface[i] && dist[i] == (float)max_dist) {
+            dist[i] = -dist[i];
+        }
+    }
+}
+
+// Convert an occupied-volume fraction to the value stored in a coverage grid.
+// Floating-point grids store the fraction itself and integer grids scale it to
+// [0, max], rounding to the nearest value.
+template <typename T>
+inline T CoverageValue(double fraction, std::true_type)
+{
+    if (fraction >= 1.0) {
+        return std::numeric_limits<T>::max();
+    }
+    return (T)((double)std::numeric_limits<T>::max() * fraction + 0.5);
+}
+
+template <typename T>
+inline T CoverageValue(double fraction, std::false_type)
+{
+    static_assert(std::is_floating_point<T>::value,
+            "coverage grids must store floating-point or integer values");
+    return (T)fraction;
+}
+
+template <typename T>
+inline T CoverageValue(double fraction)
+{
+    return CoverageValue<T>(fraction, std::is_integral<T>());
+}
+
+// Store, for each cell of a grid within a box, the fraction of samples x
+// samples x samples points, spaced evenly through the cell, that lie inside a
+// solid. Cells keep the larger of their existing and new coverage.
+template <typename Discretizer, typename T, typename Inside>
+void VoxelizeSolidCoverage(
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max,
+    int samples,
+    const Inside& inside,
+    VoxelGrid<Discretizer, T>& vg)
+{
+    if (samples < 1) {
+        return;
+    }
+
+    GridCoord gmin = vg.worldToGrid(WorldCoord(min.x(), min.y(), min.z()));
+    GridCoord gmax = vg.worldToGrid(WorldCoord(max.x(), max.y(), max.z()));
+    gmin.x = std::max(gmin.x, vg.minGridCoord().x);
+    gmin.y = std::max(gmin.y, vg.minGridCoord().y);
+    gmin.z = std::max(gmin.z, vg.minGridCoord().z);
+    gmax.x = std::min(gmax.x, vg.maxGridCoord().x);
+    gmax.y = std::min(gmax.y, vg.maxGridCoord().y);
+    gmax.z = std::min(gmax.z, vg.maxGridCoord().z);
+
+    // offsets of the sample points from the cell center
+    std::vector<Eigen::Vector3d> offsets;
+    offsets.reserve(samples * samples * samples);
+    for (int i = 0; i < samples; ++i) {
+        for (int j = 0; j < samples; ++j) {
+            for (int k = 0; k < samples; ++k) {
+                offsets.push_back(Eigen::Vector3d(
+                        ((i + 0.5) / samples - 0.5) * vg.res().x(),
+                        ((j + 0.5) / samples - 0.5) * vg.res().y(),
+                        ((k + 0.5) / samples - 0.5) * vg.res().z()));
+            }
+        }
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int gx = gmin.x; gx <= gmax.x; ++gx) {
+        for (int gy = gmin.y; gy <= gmax.y; ++gy) {
+            for (int gz = gmin.z; gz <= gmax.z; ++gz) {
+                const GridCoord gc(gx, gy, gz);
+                const WorldCoord wc = vg.gridToWorld(gc);
+                const Eigen::Vector3d center(wc.x, wc.y, wc.z);
+                int count = 0;
+                for (const Eigen::Vector3d& offset : offsets) {
+                    count += inside(center + offset);
+                }
+                if (count > 0) {
+                    const T value = CoverageValue<T>(
+                            (double)count / (double)offsets.size());
+                    vg[gc] = std::max(vg[gc], value);
+                }
+            }
+        }
+    }
+}
+
+// Compute the axis-aligned bounding box of a box in the local frame of a pose
+inline void ComputePosedBoxBounds(
+    const Eigen::Vector3d& half,
+    const Eigen::Affine3d& pose,
+    Eigen::Vector3d& min,
+    Eigen::Vector3d& max)
+{
+    const Eigen::Vector3d extent = pose.linear().cwiseAbs() * half;
+    min = pose.translation() - extent;
+    max = pose.translation() + extent;
+}
+
+/// \brief Store the approximate fraction of each cell occupied by a box
+///
+/// The fraction is estimated by testing samples^3 points spaced evenly through
+/// each cell. Floating-point grids store the fraction and integer grids store
+/// it scaled to [0, max] of their type. Each cell keeps the larger of its
+/// existing and new coverage, so several solids may be voxelized into the same
+/// grid.
+template <typename Discretizer, typename T>
+void VoxelizeBoxCoverage(
+    double length,
+    double width,
+    double height,
+    const Eigen::Affine3d& pose,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples)
+{
+    const Eigen::Vector3d half(0.5 * length, 0.5 * width, 0.5 * height);
+    const Eigen::Affine3d inv = pose.inverse();
+    Eigen::Vector3d min, max;
+    ComputePosedBoxBounds(half, pose, min, max);
+    VoxelizeSolidCoverage(
+            min, max, samples,
+            [&](const Eigen::Vector3d& p)
+            {
+                const Eigen::Vector3d q = (inv * p).cwiseAbs();
+                return q.x() <= half.x() && q.y() <= half.y() && q.z() <= half.z();
+            },
+            vg);
+}
+
+/// \brief Store the approximate fraction of each cell occupied by a sphere
+///
+/// See VoxelizeBoxCoverage.
+template <typename Discretizer, typename T>
+void VoxelizeSphereCoverage(
+    double radius,
+    const Eigen::Affine3d& pose,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples)
+{
+    const Eigen::Vector3d center = pose.translation();
+    const Eigen::Vector3d half = Eigen::Vector3d::Constant(radius);
+    VoxelizeSolidCoverage(
+            center - half, center + half, samples,
+            [&](const Eigen::Vector3d& p)
+            {
+                return (p - center).squaredNorm() <= radius * radius;
+            },
+            vg);
+}
+
+/// \brief Store the approximate fraction of each cell occupied by a cylinder
+///
+/// The cylinder is centered on the origin of its pose with its axis along z.
+/// See VoxelizeBoxCoverage.
+template <typename Discretizer, typename T>
+void VoxelizeCylinderCoverage(
+    double radius,
+    double length,
+    const Eigen::Affine3d& pose,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples)
+{
+    const Eigen::Affine3d inv = pose.inverse();
+    Eigen::Vector3d min, max;
+    ComputePosedBoxBounds(
+            Eigen::Vector3d(radius, radius, 0.5 * length), pose, min, max);
+    VoxelizeSolidCoverage(
+            min, max, samples,
+            [&](const Eigen::Vector3d& p)
+            {
+                const Eigen::Vector3d q = inv * p;
+                return std::fabs(q.z()) <= 0.5 * length &&
+                        q.x() * q.x() + q.y() * q.y() <= radius * radius;
+            },
+            vg);
+}
+
+/// \brief Store the approximate fraction of each cell occupied by a cone
+///
+/// The cone is centered on the origin of its pose with its base at
+/// z = -height / 2 and its apex at z = height / 2. See VoxelizeBoxCoverage.
+template <typename Discretizer, typename T>
+void VoxelizeConeCoverage(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples)
+{
+    const Eigen::Affine3d inv = pose.inverse();
+    Eigen::Vector3d min, max;
+    ComputePosedBoxBounds(
+            Eigen::Vector3d(radius, radius, 0.5 * height), pose, min, max);
+    VoxelizeSolidCoverage(
+            min, max, samples,
+            [&](const Eigen::Vector3d& p)
+            {
+                const Eigen::Vector3d q = inv * p;
+                if (std::fabs(q.z()) > 0.5 * height) {
+                    return false;
+                }
+                const double r = radius * (0.5 - q.z() / height);
+                return q.x() * q.x() + q.y() * q.y() <= r * r;
+            },
+            vg);
+}
+
+/// \brief Store the approximate fraction of each cell occupied by the
+///     interior of a closed mesh
+///
+/// The mesh is voxelized and filled at samples times the resolution of the
+/// grid, with the finer cells nested in those of the grid, and each cell
+/// stores the fraction of its finer cells that are occupied. Finer cells on
+/// the thinnest (6-separating) surface straddle it and count as half
+/// occupied, except where the mesh lies on the boundaries of the finer cells,
+/// where the cells inside it count as occupied. Values are stored as in
+/// VoxelizeBoxCoverage.
+template <typename Discretizer, typename T>
+void VoxelizeMeshCoverage(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples)
+{
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+    if (samples < 1 || !ComputeAxisAlignedBoundingBox(vertices, min, max)) {
+        return;
+    }
+
+    // the finer grid spans the full extent of the mesh along z so that it may
+    // be filled, and a cell beyond it on every side, which the surface may
+    // reach when the mesh lies on cell boundaries
+    GridCoord gmin = vg.worldToGrid(WorldCoord(min.x(), min.y(), min.z()));
+    GridCoord gmax = vg.worldToGrid(WorldCoord(max.x(), max.y(), max.z()));
+    gmin = GridCoord(gmin.x - 1, gmin.y - 1, gmin.z - 1);
+    gmax = GridCoord(gmax.x + 1, gmax.y + 1, gmax.z + 1);
+    gmin.x = std::max(gmin.x, vg.minGridCoord().x);
+    gmin.y = std::max(gmin.y, vg.minGridCoord().y);
+    gmax.x = std::min(gmax.x, vg.maxGridCoord().x);
+    gmax.y = std::min(gmax.y, vg.maxGridCoord().y);
+    if (gmin.x > gmax.x || gmin.y > gmax.y ||
+        gmax.z < vg.minGridCoord().z || gmin.z > vg.maxGridCoord().z)
+    {
+        return;
+    }
+
+    const Eigen::Vector3d fine_res = vg.res() / samples;
+    const int count_x = gmax.x - gmin.x + 1;
+    const int count_y = gmax.y - gmin.y + 1;
+    const int count_z = gmax.z - gmin.z + 1;
+
+    // center the first finer cell in the lower corner of the first cell, and
+    // pad the finer grid by one finer cell on every side so that the surface
+    // is closed within it and the fill starts outside the mesh
+    const WorldCoord first = vg.gridToWorld(gmin);
+    const Eigen::Vector3d pivot =
+            Eigen::Vector3d(first.x, first.y, first.z) -
+            0.5 * vg.res() + 0.5 * fine_res;
+    const int pad = 1;
+    VoxelGrid<PivotDiscretizer> fine(
+            pivot - pad * fine_res,
+            Eigen::Vector3d(
+                    (count_x * samples + 2 * pad - 1) * fine_res.x(),
+                    (count_y * samples + 2 * pad - 1) * fine_res.y(),
+                    (count_z * samples + 2 * pad - 1) * fine_res.z()),
+            fine_res,
+            PivotDiscretizer(fine_res.x(), pivot.x()),
+            PivotDiscretizer(fine_res.y(), pivot.y()),
+            PivotDiscretizer(fine_res.z(), pivot.z()));
+    VoxelizeMesh(vertices, indices, fine, false, Separability::Six);
+
+    // surface cells, marked before filling the interior, straddle the surface
+    // and count as half occupied. Where the surface is two cells thick, as
+    // when the mesh lies on the boundaries of the finer cells, it is instead
+    // split between its inner cells, which touch the interior but not the
+    // exterior, and count as occupied, and its outer cells, which touch the
+    // exterior but not the interior, and count as empty.
+    const size_t fine_count =
+            (size_t)fine.sizeX() * fine.sizeY() * fine.sizeZ();
+    for (size_t i = 0; i < fine_count; ++i) {
+        fine.data()[i] *= 2;
+    }
+    ScanFill(fine);
+
+    const int fsx = fine.sizeX();
+    const int fsy = fine.sizeY();
+    const int fsz = fine.sizeZ();
+    const unsigned char* fdata = fine.data();
+    auto fine_index = [&](int x, int y, int z)
+    {
+        return ((size_t)x * fsy + y) * fsz + z;
+    };
+    auto in_fine = [&](int x, int y, int z)
+    {
+        return x >= 0 && x < fsx && y >= 0 && y < fsy && z >= 0 && z < fsz;
+    };
+
+    // classify the surface cells as inner, outer, or neither
+    const unsigned char INNER = 1;
+    const unsigned char OUTER = 2;
+    std::vector<unsigned char> sides(fine_count, 0);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < fsx; ++x) {
+        for (int y = 0; y < fsy; ++y) {
+            for (int z = 0; z < fsz; ++z) {
+                if (fdata[fine_index(x, y, z)] != 2) {
+                    continue;
+                }
+                bool interior = false;
+                bool exterior = false;
+                for (int dx = -1; dx <= 1; ++dx) {
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dz = -1; dz <= 1; ++dz) {
+                            if (!in_fine(x + dx, y + dy, z + dz)) {
+                                continue;
+                            }
+                            const unsigned char n =
+                                    fdata[fine_index(x + dx, y + dy, z + dz)];
+                            // the exterior is only touched across faces
+                            const int dist =
+                                    std::abs(dx) + std::abs(dy) + std::abs(dz);
+                            interior |= n == 1;
+                            exterior |= n == 0 && dist == 1;
+                        }
+                    }
+                }
+                if (interior != exterior) {
+                    sides[fine_index(x, y, z)] = interior ? INNER : OUTER;
+                }
+            }
+        }
+    }
+
+    // weights of the finer cells, in halves of a cell. Inner and outer cells
+    // take their side only when paired across a face with a cell of the
+    // other side, so that thin surfaces still count as half occupied.
+    std::vector<unsigned char> weights(fine_count, 0);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < fsx; ++x) {
+        for (int y = 0; y < fsy; ++y) {
+            for (int z = 0; z < fsz; ++z) {
+                const size_t i = fine_index(x, y, z);
+                if (fdata[i] != 2) {
+                    weights[i] = fdata[i] == 1 ? 2 : 0;
+                    continue;
+                }
+                weights[i] = 1;
+                if (!sides[i]) {
+                    continue;
+                }
+                const int offsets[6][3] = {
+                    { -1, 0, 0 }, { 1, 0, 0 },
+                    { 0, -1, 0 }, { 0, 1, 0 },
+                    { 0, 0, -1 }, { 0, 0, 1 },
+                };
+                for (int k = 0; k < 6; ++k) {
+                    const int nx = x + offsets[k][0];
+                    const int ny = y + offsets[k][1];
+                    const int nz = z + offsets[k][2];
+                    if (in_fine(nx, ny, nz) &&
+                        sides[fine_index(nx, ny, nz)] == (sides[i] ^ 3))
+                    {
+                        weights[i] = sides[i] == INNER ? 2 : 0;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    const int zlo = std::max(gmin.z, vg.minGridCoord().z);
+    const int zhi = std::min(gmax.z, vg.maxGridCoord().z);
+    const double cell_samples = 2.0 * samples * samples * samples;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int cx = 0; cx < count_x; ++cx) {
+        for (int cy = 0; cy < count_y; ++cy) {
+            for (int gz = zlo; gz <= zhi; ++gz) {
+                const int cz = gz - gmin.z;
+                int count = 0;
+                for (int i = 0; i < samples; ++i) {
+                    for (int j = 0; j < samples; ++j) {
+                        const unsigned char* row = &weights[fine_index(
+                                pad + cx * samples + i,
+                                pad + cy * samples + j,
+                                pad + cz * samples)];
+                        for (int k = 0; k < samples; ++k) {
+                            count += row[k];
+                        }
+                    }
+                }
+                if (count > 0) {
+                    const GridCoord gc(gmin.x + cx, gmin.y + cy, gz);
+                    const T value = CoverageValue<T>(count / cell_samples);
+                    vg[gc] = std::max(vg[gc], value);
+                }
+            }
+        }
+    }
+}
+
+// Fill the interior of closed surfaces by scanning each z-row of a grid or view
+template <typename Grid>
+void ScanFillCells(Grid& vg)
+{
+    for (int x = 0; x < vg.sizeX(); x++) {
+        for (int y = 0; y < vg.sizeY(); y++) {
+            const int OUTSIDE = 0;
+            const int ON_BOUNDARY_FROM_OUTSIDE = 1;
+            const int INSIDE = 2;
+            const int ON_BOUNDARY_FROM_INSIDE = 4;
+
+            int scan_state = OUTSIDE;
+
+            for (int z = 0; z < vg.sizeZ(); z++) {
+                if (scan_state == OUTSIDE && vg[MemoryCoord(x, y, z)]) {
+                    scan_state = ON_BOUNDARY_FROM_OUTSIDE;
+                }
+                else if (scan_state == ON_BOUNDARY_FROM_OUTSIDE &&
+                    !vg[MemoryCoord(x, y, z)])
+                {
+                    bool allEmpty = true;
+                    for (int l = z; l < vg.sizeZ(); l++) {
+                        allEmpty &= !vg[MemoryCoord(x, y, l)];
+                    }
+                    if (allEmpty) {
+                        scan_state = OUTSIDE;
+                    }
+                    else {
+                        scan_state = INSIDE;
+                        vg[MemoryCoord(x, y, z)] = true;
+                    }
+                }
+                else if (scan_state == INSIDE && !vg[MemoryCoord(x, y, z)]) {
+                    vg[MemoryCoord(x, y, z)] = true;
+                }
+                else if (scan_state == INSIDE && vg[MemoryCoord(x, y, z)]) {
+                    scan_state = ON_BOUNDARY_FROM_INSIDE;
+                }
+                else if (scan_state == ON_BOUNDARY_FROM_INSIDE &&
+                    !vg[MemoryCoord(x, y, z)])
+                {
+                    scan_state = OUTSIDE;
+                }
+            }
+        }
+    }
+}
+
+/// \brief Fill the interior of a voxel grid via scanning
+template <typename Discretizer>
+void ScanFill(VoxelGrid<Discretizer>& vg)
+{
+    ScanFillCells(vg);
+}
+
+/// \brief Fill the interior of closed surfaces within a view
+///
+/// Each z-row of the view is scanned independently, so the view should span
+/// the full extent of the surfaces along z.
+template <typename Discretizer>
+void ScanFill(VoxelGridView<Discretizer> view)
+{
+    ScanFillCells(view);
+}
+
+/// \brief Count the nonzero cells of a voxel grid
+template <typename Discretizer, typename T>
+size_t CountVoxels(const VoxelGrid<Discretizer, T>& vg)
+{
+    const size_t n = (size_t)vg.sizeX() * vg.sizeY() * vg.sizeZ();
+    const T* data = vg.data();
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += data[i] != T();
+    }
+    return count;
+}
+
+// Mask the high bit of each nonzero byte in a word of eight cells
+inline std::uint64_t OccupiedCellMask(const unsigned char* cells)
+{
+    const std::uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+    std::uint64_t w;
+    memcpy(&w, cells, sizeof(w));
+    return (((w & low7) + low7) | w) & ~low7;
+}
+
+// Count the nonzero cells in a contiguous range of cells
+inline size_t CountOccupiedCells(const unsigned char* cells, size_t n)
+{
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= n; i += sizeof(std::uint64_t)) {
+        count += __builtin_popcountll(OccupiedCellMask(cells + i));
+    }
+    for (; i < n; ++i) {
+        count += cells[i] != 0;
+    }
+    return count;
+}
+
+// Call a function with the offset of each nonzero cell in a contiguous range
+// of cells, in increasing order. Empty words are skipped whole and occupied
+// cells within a word are found by scanning for the lowest set bit, which
+// belongs to the cell at the lowest address only on little-endian machines.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "ForEachOccupiedCell assumes a little-endian byte order"
+#endif
+template <typename Visit>
+void ForEachOccupiedCell(const unsigned char* cells, size_t n, Visit visit)
+{
+    size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= n; i += sizeof(std::uint64_t)) {
+        std::uint64_t mask = OccupiedCellMask(cells + i);
+        while (mask) {
+            visit(i + (__builtin_ctzll(mask) >> 3));
+            mask &= mask - 1;
+        }
+    }
+    for (; i < n; ++i) {
+        if (cells[i]) {
+            visit(i);
+        }
+    }
+}
+
+/// \brief Count the occupied cells of a voxel grid
+///
+/// Cells are scanned eight at a time, setting the high bit of each nonzero
+/// byte in a word and counting the set bits, so the count does not depend on
+/// the values written to occupied cells.
+template <typename Discretizer>
+size_t CountVoxels(const VoxelGrid<Discretizer>& vg)
+{
+    const size_t n = (size_t)vg.sizeX() * vg.sizeY() * vg.sizeZ();
+    return CountOccupiedCells(vg.data(), n);
+}
+
+template <typename Discretizer, typename T>
+size_t CountVoxels(const VoxelGridView<Discretizer, T>& view)
+{
+    size_t count = 0;
+    for (int x = 0; x < view.sizeX(); ++x) {
+        for (int y = 0; y < view.sizeY(); ++y) {
+            const T* row = view.row(x, y);
+            for (int z = 0; z < view.sizeZ(); ++z) {
+                count += row[z] != typename std::remove_const<T>::type();
+            }
+        }
+    }
+    return count;
+}
+
+// Append an element, made from the memory coordinates of each occupied cell,
+// for all occupied cells of a voxel grid, in memory order. The occupied cells
+// of each x-slab are counted first so that the output is grown once and each
+// slab, in parallel, writes directly to its own range of the output.
+template <typename Discretizer, typename U, typename MakeElement>
+void ExtractOccupiedCells(
+    const VoxelGrid<Discretizer>& vg,
+    const MakeElement& make_element,
+    std::vector<U>& out)
+{
+    const int sx = vg.sizeX();
+    const int sz = vg.sizeZ();
+    const size_t slab_size = (size_t)vg.sizeY() * sz;
+    const unsigned char* data = vg.data();
+
+    // offsets[x] is the number of occupied cells in the slabs before x
+    std::vector<size_t> offsets(sx + 1, 0);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < sx; ++x) {
+        offsets[x + 1] = CountOccupiedCells(data + x * slab_size, slab_size);
+    }
+    for (int x = 0; x < sx; ++x) {
+        offsets[x + 1] += offsets[x];
+    }
+
+    const size_t base = out.size();
+    out.resize(base + offsets[sx]);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < sx; ++x) {
+        U* dst = out.data() + base + offsets[x];
+        ForEachOccupiedCell(
+                data + x * slab_size, slab_size,
+                [&](size_t i)
+                {
+                    *dst++ = make_element(
+                            MemoryCoord(x, (int)(i / sz), (int)(i % sz)));
+                });
+    }
+}
+
+/// \brief Append the centers of all occupied cells of a voxel grid to a vector
+///     of voxels
+///
+/// Voxels are appended in memory order.
+template <typename Discretizer>
+void ExtractVoxels(
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& voxels)
+{
+    ExtractOccupiedCells(
+            vg,
+            [&](const MemoryCoord& mc)
+            {
+                const WorldCoord wc = vg.memoryToWorld(mc);
+                return Eigen::Vector3d(wc.x, wc.y, wc.z);
+            },
+            voxels);
+}
+
+/// \brief Append the keys of all occupied cells of a voxel grid to a vector of
+///     keys
+///
+/// Keys are appended in memory order, which is also increasing key order.
+/// \return false if the grid coordinates of the grid cannot be packed into
+///     keys
+template <typename Discretizer>
+bool ExtractVoxelKeys(
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<VoxelKey>& keys)
+{
+    if (!VoxelKey::IsRepresentable(vg.minGridCoord()) ||
+        !VoxelKey::IsRepresentable(vg.maxGridCoord()))
+    {
+        std::cerr << "Voxel grid extends beyond the range of voxel keys" << std::endl;
+        return false;
+    }
+
+    ExtractOccupiedCells(
+            vg,
+            [&](const MemoryCoord& mc)
+            {
+                return VoxelKey(vg.memoryToGrid(mc));
+            },
+            keys);
+    return true;
+}
+
 } // namespace sbpl
 
 #endif
@@ -32,16 +32,33 @@
 
 #include <sbpl_geometry_utils/angles.h>
 #include <sbpl_geometry_utils/bounding_spheres.h>
+#include <sbpl_geometry_utils/brick_voxel_grid.h>
+#include <sbpl_geometry_utils/bvh.h>
+#include <sbpl_geometry_utils/connected_components.h>
+#include <sbpl_geometry_utils/cspace.h>
 #include <sbpl_geometry_utils/discretize.h>
 #include <sbpl_geometry_utils/interpolate.h>
+#include <sbpl_geometry_utils/intersect.h>
+#include <sbpl_geometry_utils/isosurface.h>
 #include <sbpl_geometry_utils/measure_similarity.h>
+#include <sbpl_geometry_utils/mesh_io.h>
 #include <sbpl_geometry_utils/mesh_utils.h>
+#include <sbpl_geometry_utils/morphology.h>
+#include <sbpl_geometry_utils/packed_voxel_grid.h>
+#include <sbpl_geometry_utils/projection.h>
 #include <sbpl_geometry_utils/rasterize.h>
+#include <sbpl_geometry_utils/rolling_voxel_grid.h>
+#include <sbpl_geometry_utils/scene_voxelizer.h>
 #include <sbpl_geometry_utils/shortcut.h>
 #include <sbpl_geometry_utils/sphere.h>
 #include <sbpl_geometry_utils/triangle.h>
 #include <sbpl_geometry_utils/utils.h>
+#include <sbpl_geometry_utils/versioned_voxel_grid.h>
 #include <sbpl_geometry_utils/voxel_grid.h>
+#include <sbpl_geometry_utils/voxel_grid_view.h>
+#include <sbpl_geometry_utils/voxel_key.h>
+#include <sbpl_geometry_utils/voxel_ops.h>
+#include <sbpl_geometry_utils/voxel_template.h>
 #include <sbpl_geometry_utils/voxelize.h>
 
 #endif
@@ -0,0 +1,95 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_intersect_h
+#define sbpl_geometry_intersect_h
+
+// standard includes
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/triangle.h>
+
+namespace sbpl {
+
+/// \brief Structure-of-arrays storage for a set of triangles
+///
+/// Storing each coordinate of each vertex contiguously allows the rejection
+/// tests of the batched intersection routines to be vectorized.
+struct TriangleArray
+{
+    std::vector<double> ax, ay, az;
+    std::vector<double> bx, by, bz;
+    std::vector<double> cx, cy, cz;
+
+    TriangleArray() { }
+
+    TriangleArray(
+        const std::vector<Eigen::Vector3d>& vertices,
+        const std::vector<int>& indices);
+
+    size_t size() const { return ax.size(); }
+    bool empty() const { return ax.empty(); }
+
+    void reserve(size_t n);
+    void clear();
+    void push_back(const Triangle& tr);
+
+    Triangle operator[](size_t i) const
+    {
+        return Triangle(
+                Eigen::Vector3d(ax[i], ay[i], az[i]),
+                Eigen::Vector3d(bx[i], by[i], bz[i]),
+                Eigen::Vector3d(cx[i], cy[i], cz[i]));
+    }
+};
+
+bool Intersects(const Triangle& tr1, const Triangle& tr2, double eps = 1.0e-9);
+
+void IntersectingTriangles(
+    const Triangle& tr,
+    const TriangleArray& triangles,
+    std::vector<int>& indices,
+    double eps = 1.0e-9);
+
+bool IntersectsAny(
+    const Triangle& tr,
+    const TriangleArray& triangles,
+    double eps = 1.0e-9);
+
+Eigen::Vector3d ClosestPointOnTriangle(
+    const Eigen::Vector3d& p,
+    const Triangle& tr);
+
+} // namespace sbpl
+
+#endif
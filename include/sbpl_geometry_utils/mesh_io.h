@@ -0,0 +1,119 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_mesh_io_h
+#define sbpl_geometry_mesh_io_h
+
+// standard includes
+#include <fstream>
+#include <string>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/triangle.h>
+
+namespace sbpl {
+
+/// \brief Streaming reader for binary and ASCII STL files
+///
+/// Binary files are memory-mapped and pages are released as triangles are
+/// consumed, so the resident size of the reader stays bounded by the chunk size
+/// rather than the file size. ASCII files are parsed incrementally.
+class StlReader
+{
+public:
+
+    StlReader();
+    ~StlReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const;
+
+    /// \brief The number of triangles in a binary file; 0 for ASCII files
+    size_t triangleCount() const { return m_count; }
+
+    size_t read(size_t max_count, std::vector<Triangle>& triangles);
+
+private:
+
+    // binary file state
+    int m_fd;
+    const unsigned char* m_data;
+    size_t m_size;
+    size_t m_count;
+    size_t m_next;
+    size_t m_released; // bytes of the mapping already released
+
+    // ascii file state
+    std::ifstream m_ascii;
+
+    StlReader(const StlReader&);
+    StlReader& operator=(const StlReader&);
+
+    size_t readBinary(size_t max_count, std::vector<Triangle>& triangles);
+    size_t readAscii(size_t max_count, std::vector<Triangle>& triangles);
+};
+
+/// \brief Streaming reader for Wavefront OBJ files
+///
+/// Faces are triangulated as fans and returned as they are parsed. Since faces
+/// may reference any previously declared vertex, vertex positions are retained
+/// (in single precision) while the file is read; texture coordinates, normals,
+/// and all other statements are skipped.
+class ObjReader
+{
+public:
+
+    ObjReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_file.is_open(); }
+
+    size_t read(size_t max_count, std::vector<Triangle>& triangles);
+
+private:
+
+    std::ifstream m_file;
+    std::vector<Eigen::Vector3f> m_vertices;
+
+    // triangles of the current face not yet returned
+    std::vector<Triangle> m_pending;
+    size_t m_pending_next;
+};
+
+} // namespace sbpl
+
+#endif
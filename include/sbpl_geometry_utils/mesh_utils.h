@@ -90,6 +90,45 @@ void CreateGridMesh(
     const VoxelGrid<Discretizer>& vg,
     std::vector<Eigen::Vector3d>& vertices);
 
+/// \brief Create a mesh of the exposed faces of the occupied voxels of a grid
+///
+/// Only faces between an occupied voxel and an empty voxel (or the outside of
+/// the grid) are emitted, and coplanar faces with the same orientation are
+/// greedily merged into maximal rectangles, each emitted as two triangles with
+/// outward-facing counterclockwise winding. Slices are meshed in parallel.
+/// Vertices are shared between rectangles that meet at their corners; since
+/// rectangles may also meet along their edges, the mesh may contain
+/// T-junctions. Output vertices and indices are appended to the input vectors.
+template <typename Discretizer>
+void CreateIndexedVoxelSurfaceMesh(
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& indices);
+
+void SimplifyMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    std::vector<Eigen::Vector3d>& simple_vertices,
+    std::vector<int>& simple_indices);
+
+void SimplifyMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    std::vector<Eigen::Vector3d>& simple_vertices,
+    std::vector<int>& simple_indices);
+
+/// \brief Simplify a mesh by clustering its vertices into the cells of a grid
+template <typename Discretizer>
+void SimplifyMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& simple_vertices,
+    std::vector<int>& simple_indices);
+
 } // namespace sbpl
 
 #include "detail/mesh_utils.h"
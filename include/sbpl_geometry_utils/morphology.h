@@ -0,0 +1,89 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_morphology_h
+#define sbpl_geometry_morphology_h
+
+// standard includes
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/packed_voxel_grid.h>
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+enum class StructuringElement
+{
+    Box,    ///< cube with half-width radius
+    Cross,  ///< axis-aligned arms of length radius
+    Sphere  ///< approximate ball of radius cells
+};
+
+void DilateVoxels(
+    PackedVoxelGrid& grid,
+    int radius,
+    StructuringElement element = StructuringElement::Box);
+
+void ErodeVoxels(
+    PackedVoxelGrid& grid,
+    int radius,
+    StructuringElement element = StructuringElement::Box);
+
+void SquaredDistanceTransform(
+    const PackedVoxelGrid& sites,
+    const Eigen::Vector3d& spacing,
+    std::vector<double>& d2);
+
+template <typename Discretizer>
+void DilateVoxels(
+    VoxelGrid<Discretizer>& vg,
+    int radius,
+    StructuringElement element = StructuringElement::Box);
+
+template <typename Discretizer>
+void ErodeVoxels(
+    VoxelGrid<Discretizer>& vg,
+    int radius,
+    StructuringElement element = StructuringElement::Box);
+
+template <typename Discretizer>
+void DilateVoxelsEuclidean(VoxelGrid<Discretizer>& vg, double radius);
+
+template <typename Discretizer>
+void ErodeVoxelsEuclidean(VoxelGrid<Discretizer>& vg, double radius);
+
+} // namespace sbpl
+
+#include "detail/morphology.h"
+
+#endif
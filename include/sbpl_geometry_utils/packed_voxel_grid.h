@@ -0,0 +1,180 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_packed_voxel_grid_h
+#define sbpl_geometry_packed_voxel_grid_h
+
+// standard includes
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+/// \brief Occupancy grid storing one bit per cell, packed along z
+///
+/// Each (x, y) row of cells along z is stored in wordsPerRow() consecutive
+/// 64-bit words, with cell z at bit z % 64 of word z / 64. Bits past the end
+/// of a row are kept clear. Cells are indexed by memory coordinates of the
+/// VoxelGrid the packed grid was created from.
+class PackedVoxelGrid
+{
+public:
+
+    typedef std::uint64_t word_type;
+
+    static const int WORD_BITS = 64;
+
+    PackedVoxelGrid() : m_size_x(0), m_size_y(0), m_size_z(0), m_words(0) { }
+
+    PackedVoxelGrid(int size_x, int size_y, int size_z) { resize(size_x, size_y, size_z); }
+
+    void resize(int size_x, int size_y, int size_z)
+    {
+        m_size_x = size_x;
+        m_size_y = size_y;
+        m_size_z = size_z;
+        m_words = (size_z + WORD_BITS - 1) / WORD_BITS;
+        m_bits.assign((size_t)size_x * size_y * m_words, 0);
+    }
+
+    int sizeX() const { return m_size_x; }
+    int sizeY() const { return m_size_y; }
+    int sizeZ() const { return m_size_z; }
+    int wordsPerRow() const { return m_words; }
+
+    word_type* row(int x, int y) { return &m_bits[((size_t)x * m_size_y + y) * m_words]; }
+    const word_type* row(int x, int y) const { return &m_bits[((size_t)x * m_size_y + y) * m_words]; }
+
+    word_type* data() { return m_bits.data(); }
+    const word_type* data() const { return m_bits.data(); }
+
+    bool test(int x, int y, int z) const
+    {
+        return (row(x, y)[z / WORD_BITS] >> (z % WORD_BITS)) & 1;
+    }
+
+    void set(int x, int y, int z)
+    {
+        row(x, y)[z / WORD_BITS] |= word_type(1) << (z % WORD_BITS);
+    }
+
+    void reset(int x, int y, int z)
+    {
+        row(x, y)[z / WORD_BITS] &= ~(word_type(1) << (z % WORD_BITS));
+    }
+
+    /// \brief Mask of the valid bits in the last word of each row
+    word_type lastWordMask() const
+    {
+        const int rem = m_size_z % WORD_BITS;
+        return rem == 0 ? ~word_type(0) : (word_type(1) << rem) - 1;
+    }
+
+    /// \brief Invert every cell, keeping the bits past the end of each row clear
+    void flip()
+    {
+        const word_type mask = lastWordMask();
+        for (size_t i = 0; i < m_bits.size(); ++i) {
+            m_bits[i] = ~m_bits[i];
+            if ((i + 1) % m_words == 0) {
+                m_bits[i] &= mask;
+            }
+        }
+    }
+
+private:
+
+    int m_size_x;
+    int m_size_y;
+    int m_size_z;
+    int m_words;
+    std::vector<word_type> m_bits;
+};
+
+template <typename Discretizer, typename T>
+void PackVoxels(const VoxelGrid<Discretizer, T>& vg, PackedVoxelGrid& packed);
+
+template <typename Discretizer, typename T>
+void UnpackVoxels(const PackedVoxelGrid& packed, VoxelGrid<Discretizer, T>& vg);
+
+/// \brief Pack the nonzero cells of a voxel grid into a bit grid of the same
+///     dimensions
+template <typename Discretizer, typename T>
+void PackVoxels(const VoxelGrid<Discretizer, T>& vg, PackedVoxelGrid& packed)
+{
+    packed.resize(vg.sizeX(), vg.sizeY(), vg.sizeZ());
+    const T* data = vg.data();
+    const int sz = vg.sizeZ();
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < vg.sizeX(); ++x) {
+        for (int y = 0; y < vg.sizeY(); ++y) {
+            const T* cells = data + ((size_t)x * vg.sizeY() + y) * sz;
+            PackedVoxelGrid::word_type* row = packed.row(x, y);
+            for (int z = 0; z < sz; ++z) {
+                if (cells[z] != T()) {
+                    row[z / PackedVoxelGrid::WORD_BITS] |=
+                            PackedVoxelGrid::word_type(1) <<
+                            (z % PackedVoxelGrid::WORD_BITS);
+                }
+            }
+        }
+    }
+}
+
+/// \brief Write the cells of a bit grid into a voxel grid of the same
+///     dimensions as 0 or 1
+template <typename Discretizer, typename T>
+void UnpackVoxels(const PackedVoxelGrid& packed, VoxelGrid<Discretizer, T>& vg)
+{
+    T* data = vg.data();
+    const int sz = vg.sizeZ();
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < vg.sizeX(); ++x) {
+        for (int y = 0; y < vg.sizeY(); ++y) {
+            T* cells = data + ((size_t)x * vg.sizeY() + y) * sz;
+            const PackedVoxelGrid::word_type* row = packed.row(x, y);
+            for (int z = 0; z < sz; ++z) {
+                cells[z] = T((row[z / PackedVoxelGrid::WORD_BITS] >>
+                        (z % PackedVoxelGrid::WORD_BITS)) & 1);
+            }
+        }
+    }
+}
+
+} // namespace sbpl
+
+#endif
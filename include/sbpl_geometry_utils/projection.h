@@ -0,0 +1,78 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_projection_h
+#define sbpl_geometry_projection_h
+
+// standard includes
+#include <vector>
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+// Projections of the z-columns of a voxel grid onto a 2D grid of
+// vg.sizeX() by vg.sizeY() cells, indexed as grid[vg.sizeX() * y + x]
+// following the convention of the raster namespace. Heights are given in the
+// world frame and select the cells of each column whose grid coordinates lie
+// between those of the cells containing them.
+
+template <typename Discretizer>
+void ProjectOccupancy(
+    const VoxelGrid<Discretizer>& vg,
+    double z_min,
+    double z_max,
+    unsigned char* grid);
+
+template <typename Discretizer>
+bool ProjectOccupancyBands(
+    const VoxelGrid<Discretizer>& vg,
+    const std::vector<double>& band_edges,
+    unsigned char* grid);
+
+template <typename Discretizer, typename T>
+void ProjectMax(
+    const VoxelGrid<Discretizer, T>& vg,
+    double z_min,
+    double z_max,
+    T* grid);
+
+template <typename Discretizer, typename T>
+void ProjectMin(
+    const VoxelGrid<Discretizer, T>& vg,
+    double z_min,
+    double z_max,
+    T* grid);
+
+} // namespace sbpl
+
+#include "detail/projection.h"
+
+#endif
@@ -0,0 +1,499 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_rolling_voxel_grid_h
+#define sbpl_geometry_rolling_voxel_grid_h
+
+// standard includes
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+/// \brief Fixed-size voxel grid window that scrolls through an unbounded grid
+///
+/// Cells are stored in a 3D ring buffer indexed by their grid coordinates
+/// modulo the size of the window, so moving the window by an integer number
+/// of cells leaves the cells that remain in view untouched and only clears
+/// the slabs of cells that scroll into view. The newly exposed slabs are
+/// reported so that callers only need to voxelize those, i.e. via the region
+/// overload of VoxelizeTriangle.
+///
+/// Grid and world coordinates are absolute; memory coordinates are relative to
+/// the current corner of the window. Like VoxelGrid, cells are not bounds
+/// checked; use isInBounds() to check grid coordinates.
+template <class Discretizer, typename T = unsigned char>
+class RollingVoxelGrid : public VoxelGridBase
+{
+public:
+
+    typedef VoxelGridBase Base;
+    typedef T value_type;
+
+    /// Inclusive lower and upper grid coordinates of a box of cells
+    typedef std::pair<GridCoord, GridCoord> Region;
+
+    RollingVoxelGrid(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res,
+        const Discretizer& x_disc,
+        const Discretizer& y_disc,
+        const Discretizer& z_disc);
+
+    int sizeX() const { return m_size_x; }
+    int sizeY() const { return m_size_y; }
+    int sizeZ() const { return m_size_z; }
+
+    const GridCoord& minGridCoord() const { return m_min_gc; }
+    GridCoord maxGridCoord() const;
+
+    bool isInBounds(const GridCoord& coord) const;
+
+    void assign(const value_type& value);
+
+    /// \brief Move the window by an integer number of cells
+    ///
+    /// Cells that scroll into view are reset to value_type(). If exposed is
+    /// not null, up to three disjoint regions covering them are appended to
+    /// it.
+    void shift(int dx, int dy, int dz, std::vector<Region>* exposed = nullptr);
+
+    /// \brief Move the window so that its lower corner is at a grid coordinate
+    void moveTo(
+        const GridCoord& min,
+        std::vector<Region>* exposed = nullptr);
+
+    /// \brief Move the window so that it is centered on a world coordinate
+    void recenter(
+        const WorldCoord& center,
+        std::vector<Region>* exposed = nullptr);
+
+    value_type& operator()(const MemoryCoord& coord);
+    value_type& operator()(const GridCoord& coord);
+    value_type& operator()(const WorldCoord& coord);
+    value_type& operator[](const MemoryCoord& coord);
+    value_type& operator[](const GridCoord& coord);
+    value_type& operator[](const WorldCoord& coord);
+
+    value_type operator()(const MemoryCoord& coord) const;
+    value_type operator()(const GridCoord& coord) const;
+    value_type operator()(const WorldCoord& coord) const;
+    value_type operator[](const MemoryCoord& coord) const;
+    value_type operator[](const GridCoord& coord) const;
+    value_type operator[](const WorldCoord& coord) const;
+
+    MemoryCoord gridToMemory(const GridCoord& coord) const;
+    MemoryCoord worldToMemory(const WorldCoord& coord) const;
+    GridCoord   memoryToGrid(const MemoryCoord& coord) const;
+    GridCoord   worldToGrid(const WorldCoord& coord) const;
+    WorldCoord  memoryToWorld(const MemoryCoord& coord) const;
+    WorldCoord  gridToWorld(const GridCoord& coord) const;
+
+protected:
+
+    GridCoord m_min_gc;
+
+    int m_size_x;
+    int m_size_y;
+    int m_size_z;
+
+    Discretizer m_x_disc;
+    Discretizer m_y_disc;
+    Discretizer m_z_disc;
+
+    std::vector<value_type> m_grid;
+
+    static int Wrap(int v, int size)
+    {
+        const int w = v % size;
+        return w < 0 ? w + size : w;
+    }
+
+    size_t storageIndex(const GridCoord& coord) const
+    {
+        return ((size_t)Wrap(coord.x, m_size_x) * m_size_y +
+                Wrap(coord.y, m_size_y)) * m_size_z +
+                Wrap(coord.z, m_size_z);
+    }
+
+    void clearRegion(const GridCoord& min, const GridCoord& max);
+};
+
+template <typename Discretizer, typename T>
+RollingVoxelGrid<Discretizer, T>::RollingVoxelGrid(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& size,
+    const Eigen::Vector3d& res,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc)
+:
+    VoxelGridBase(origin, size, res),
+    m_x_disc(x_disc),
+    m_y_disc(y_disc),
+    m_z_disc(z_disc)
+{
+    m_min_gc.x = m_x_disc.discretize(origin.x());
+    m_min_gc.y = m_y_disc.discretize(origin.y());
+    m_min_gc.z = m_z_disc.discretize(origin.z());
+
+    m_size_x = m_x_disc.discretize(origin.x() + size.x()) - m_min_gc.x + 1;
+    m_size_y = m_y_disc.discretize(origin.y() + size.y()) - m_min_gc.y + 1;
+    m_size_z = m_z_disc.discretize(origin.z() + size.z()) - m_min_gc.z + 1;
+
+    m_grid.resize((size_t)m_size_x * m_size_y * m_size_z, value_type());
+}
+
+template <typename Discretizer, typename T>
+GridCoord RollingVoxelGrid<Discretizer, T>::maxGridCoord() const
+{
+    return GridCoord(
+            m_min_gc.x + m_size_x - 1,
+            m_min_gc.y + m_size_y - 1,
+            m_min_gc.z + m_size_z - 1);
+}
+
+template <typename Discretizer, typename T>
+bool RollingVoxelGrid<Discretizer, T>::isInBounds(const GridCoord& coord) const
+{
+    return coord.x >= m_min_gc.x && coord.x < m_min_gc.x + m_size_x &&
+            coord.y >= m_min_gc.y && coord.y < m_min_gc.y + m_size_y &&
+            coord.z >= m_min_gc.z && coord.z < m_min_gc.z + m_size_z;
+}
+
+template <typename Discretizer, typename T>
+void RollingVoxelGrid<Discretizer, T>::assign(const value_type& value)
+{
+    std::fill(m_grid.begin(), m_grid.end(), value);
+}
+
+template <typename Discretizer, typename T>
+void RollingVoxelGrid<Discretizer, T>::shift(
+    int dx, int dy, int dz,
+    std::vector<Region>* exposed)
+{
+    if (dx == 0 && dy == 0 && dz == 0) {
+        return;
+    }
+
+    m_min_gc.x += dx;
+    m_min_gc.y += dy;
+    m_min_gc.z += dz;
+    m_origin += Eigen::Vector3d(dx, dy, dz).cwiseProduct(m_res);
+
+    const GridCoord min = m_min_gc;
+    const GridCoord max = maxGridCoord();
+
+    // the exposed range along one axis, as [lo, hi], and the range of the
+    // window that remained in view, as [keep_lo, keep_hi]
+    struct Range { int lo, hi, keep_lo, keep_hi; };
+    auto exposed_range = [](int d, int size, int min, int max)
+    {
+        Range r;
+        if (d >= size || -d >= size) {
+            r.lo = min; r.hi = max;
+            r.keep_lo = max + 1; r.keep_hi = max;
+        }
+        else if (d > 0) {
+            r.lo = max - d + 1; r.hi = max;
+            r.keep_lo = min; r.keep_hi = max - d;
+        }
+        else {
+            r.lo = min; r.hi = min - d - 1;
+            r.keep_lo = min - d; r.keep_hi = max;
+        }
+        return r;
+    };
+
+    const Range rx = exposed_range(dx, m_size_x, min.x, max.x);
+    const Range ry = exposed_range(dy, m_size_y, min.y, max.y);
+    const Range rz = exposed_range(dz, m_size_z, min.z, max.z);
+
+    std::vector<Region> regions;
+    if (dx != 0) {
+        regions.push_back(Region(
+                GridCoord(rx.lo, min.y, min.z),
+                GridCoord(rx.hi, max.y, max.z)));
+    }
+    const int x_lo = dx != 0 ? rx.keep_lo : min.x;
+    const int x_hi = dx != 0 ? rx.keep_hi : max.x;
+    if (dy != 0 && x_lo <= x_hi) {
+        regions.push_back(Region(
+                GridCoord(x_lo, ry.lo, min.z),
+                GridCoord(x_hi, ry.hi, max.z)));
+    }
+    const int y_lo = dy != 0 ? ry.keep_lo : min.y;
+    const int y_hi = dy != 0 ? ry.keep_hi : max.y;
+    if (dz != 0 && x_lo <= x_hi && y_lo <= y_hi) {
+        regions.push_back(Region(
+                GridCoord(x_lo, y_lo, rz.lo),
+                GridCoord(x_hi, y_hi, rz.hi)));
+    }
+
+    for (const Region& region : regions) {
+        clearRegion(region.first, region.second);
+    }
+
+    if (exposed) {
+        exposed->insert(exposed->end(), regions.begin(), regions.end());
+    }
+}
+
+template <typename Discretizer, typename T>
+void RollingVoxelGrid<Discretizer, T>::moveTo(
+    const GridCoord& min,
+    std::vector<Region>* exposed)
+{
+    shift(min.x - m_min_gc.x, min.y - m_min_gc.y, min.z - m_min_gc.z, exposed);
+}
+
+template <typename Discretizer, typename T>
+void RollingVoxelGrid<Discretizer, T>::recenter(
+    const WorldCoord& center,
+    std::vector<Region>* exposed)
+{
+    const GridCoord gc = worldToGrid(center);
+    moveTo(GridCoord(
+            gc.x - m_size_x / 2, gc.y - m_size_y / 2, gc.z - m_size_z / 2),
+            exposed);
+}
+
+template <typename Discretizer, typename T>
+void RollingVoxelGrid<Discretizer, T>::clearRegion(
+    const GridCoord& min,
+    const GridCoord& max)
+{
+    for (int x = min.x; x <= max.x; ++x) {
+        for (int y = min.y; y <= max.y; ++y) {
+            // the run along z wraps around the end of the row at most once
+            const size_t row = ((size_t)Wrap(x, m_size_x) * m_size_y +
+                    Wrap(y, m_size_y)) * m_size_z;
+            const int z0 = Wrap(min.z, m_size_z);
+            const int count = max.z - min.z + 1;
+            const int first = std::min(count, m_size_z - z0);
+            std::fill(
+                    m_grid.begin() + row + z0,
+                    m_grid.begin() + row + z0 + first,
+                    value_type());
+            std::fill(
+                    m_grid.begin() + row,
+                    m_grid.begin() + row + (count - first),
+                    value_type());
+        }
+    }
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type&
+RollingVoxelGrid<Discretizer, T>::operator()(const MemoryCoord& coord)
+{
+    return m_grid[storageIndex(memoryToGrid(coord))];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type&
+RollingVoxelGrid<Discretizer, T>::operator()(const GridCoord& coord)
+{
+    return m_grid[storageIndex(coord)];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type&
+RollingVoxelGrid<Discretizer, T>::operator()(const WorldCoord& coord)
+{
+    return m_grid[storageIndex(worldToGrid(coord))];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type&
+RollingVoxelGrid<Discretizer, T>::operator[](const MemoryCoord& coord)
+{
+    return m_grid[storageIndex(memoryToGrid(coord))];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type&
+RollingVoxelGrid<Discretizer, T>::operator[](const GridCoord& coord)
+{
+    return m_grid[storageIndex(coord)];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type&
+RollingVoxelGrid<Discretizer, T>::operator[](const WorldCoord& coord)
+{
+    return m_grid[storageIndex(worldToGrid(coord))];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type
+RollingVoxelGrid<Discretizer, T>::operator()(const MemoryCoord& coord) const
+{
+    return m_grid[storageIndex(memoryToGrid(coord))];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type
+RollingVoxelGrid<Discretizer, T>::operator()(const GridCoord& coord) const
+{
+    return m_grid[storageIndex(coord)];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type
+RollingVoxelGrid<Discretizer, T>::operator()(const WorldCoord& coord) const
+{
+    return m_grid[storageIndex(worldToGrid(coord))];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type
+RollingVoxelGrid<Discretizer, T>::operator[](const MemoryCoord& coord) const
+{
+    return m_grid[storageIndex(memoryToGrid(coord))];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type
+RollingVoxelGrid<Discretizer, T>::operator[](const GridCoord& coord) const
+{
+    return m_grid[storageIndex(coord)];
+}
+
+template <typename Discretizer, typename T>
+typename RollingVoxelGrid<Discretizer, T>::value_type
+RollingVoxelGrid<Discretizer, T>::operator[](const WorldCoord& coord) const
+{
+    return m_grid[storageIndex(worldToGrid(coord))];
+}
+
+template <typename Discretizer, typename T>
+MemoryCoord
+RollingVoxelGrid<Discretizer, T>::gridToMemory(const GridCoord& coord) const
+{
+    return MemoryCoord(
+            coord.x - m_min_gc.x, coord.y - m_min_gc.y, coord.z - m_min_gc.z);
+}
+
+template <typename Discretizer, typename T>
+MemoryCoord
+RollingVoxelGrid<Discretizer, T>::worldToMemory(const WorldCoord& coord) const
+{
+    return gridToMemory(worldToGrid(coord));
+}
+
+template <typename Discretizer, typename T>
+GridCoord
+RollingVoxelGrid<Discretizer, T>::memoryToGrid(const MemoryCoord& coord) const
+{
+    return GridCoord(
+            coord.x + m_min_gc.x, coord.y + m_min_gc.y, coord.z + m_min_gc.z);
+}
+
+template <typename Discretizer, typename T>
+GridCoord
+RollingVoxelGrid<Discretizer, T>::worldToGrid(const WorldCoord& coord) const
+{
+    return GridCoord(
+            m_x_disc.discretize(coord.x),
+            m_y_disc.discretize(coord.y),
+            m_z_disc.discretize(coord.z));
+}
+
+template <typename Discretizer, typename T>
+WorldCoord
+RollingVoxelGrid<Discretizer, T>::memoryToWorld(const MemoryCoord& coord) const
+{
+    return gridToWorld(memoryToGrid(coord));
+}
+
+template <typename Discretizer, typename T>
+WorldCoord
+RollingVoxelGrid<Discretizer, T>::gridToWorld(const GridCoord& coord) const
+{
+    return WorldCoord(
+            m_x_disc.continuize(coord.x),
+            m_y_disc.continuize(coord.y),
+            m_z_disc.continuize(coord.z));
+}
+
+/////////////////////////////
+// HalfResRollingVoxelGrid //
+/////////////////////////////
+
+class HalfResRollingVoxelGrid : public RollingVoxelGrid<HalfResDiscretizer>
+{
+public:
+
+    HalfResRollingVoxelGrid(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res)
+    :
+        RollingVoxelGrid(
+            origin, size, res,
+            HalfResDiscretizer(res.x()),
+            HalfResDiscretizer(res.y()),
+            HalfResDiscretizer(res.z()))
+    { }
+};
+
+///////////////////////////
+// PivotRollingVoxelGrid //
+///////////////////////////
+
+class PivotRollingVoxelGrid : public RollingVoxelGrid<PivotDiscretizer>
+{
+public:
+
+    PivotRollingVoxelGrid(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res,
+        const Eigen::Vector3d& pivot)
+    :
+        RollingVoxelGrid(
+            origin, size, res,
+            PivotDiscretizer(res.x(), pivot.x()),
+            PivotDiscretizer(res.y(), pivot.y()),
+            PivotDiscretizer(res.z(), pivot.z()))
+    { }
+};
+
+} // namespace sbpl
+
+#endif
@@ -0,0 +1,340 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_scene_voxelizer_h
+#define sbpl_geometry_scene_voxelizer_h
+
+// standard includes
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/mesh_utils.h>
+#include <sbpl_geometry_utils/voxel_grid.h>
+#include <sbpl_geometry_utils/voxelize.h>
+
+namespace sbpl {
+
+/// \brief Maintains the voxelization of a scene of posed objects, updating
+///     only the objects that have moved
+///
+/// Each registered object keeps the set of cells it occupied when it was last
+/// voxelized, and each cell of the scene keeps a count of the objects
+/// occupying it. When update() is called, objects whose pose has moved by more
+/// than the translation or rotation tolerance since they were last voxelized
+/// are re-voxelized, their previous cells released, and their new cells
+/// acquired; all other objects are left untouched. A cell of grid() is
+/// occupied while its count is nonzero. Moved objects are voxelized in
+/// parallel.
+///
+/// Primitives are registered as their meshes, as created by
+/// CreateIndexedBoxMesh, CreateIndexedSphereMesh, etc. Cells outside of the
+/// scene's extents are ignored.
+template <class Discretizer>
+class SceneVoxelizer
+{
+public:
+
+    typedef std::uint16_t count_type;
+
+    SceneVoxelizer(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res,
+        const Discretizer& x_disc,
+        const Discretizer& y_disc,
+        const Discretizer& z_disc);
+
+    /// \brief Set how far an object must move before it is re-voxelized
+    void setTolerance(double translation, double rotation);
+
+    /// \brief Register a mesh, given in its local frame, at a pose
+    /// \return The id of the object
+    int addObject(
+        const std::vector<Eigen::Vector3d>& vertices,
+        const std::vector<int>& indices,
+        const Eigen::Affine3d& pose,
+        bool fill = false);
+
+    bool setPose(int id, const Eigen::Affine3d& pose);
+    bool removeObject(int id);
+
+    /// \brief Bring the scene up to date with the objects' current poses
+    /// \return The number of objects re-voxelized
+    size_t update();
+
+    /// \brief Return the occupancy of the scene as of the last update()
+    const VoxelGrid<Discretizer>& grid() const { return m_grid; }
+
+    /// \brief Return the number of objects occupying each cell
+    const VoxelGrid<Discretizer, count_type>& counts() const { return m_counts; }
+
+private:
+
+    struct Object
+    {
+        std::vector<Eigen::Vector3d> vertices;
+        std::vector<int> indices;
+        bool fill;
+
+        Eigen::Affine3d pose;           // current pose
+        Eigen::Affine3d voxelized_pose; // pose of the cells below
+
+        bool active;                    // registered and not removed
+        bool voxelized;                 // cells reflect voxelized_pose
+        std::vector<int> cells;         // memory indices of occupied cells
+    };
+
+    // write policy that records the memory index of each written cell
+    struct RecordCell
+    {
+        const count_type* base;
+        std::vector<int>* cells;
+
+        void operator()(count_type& cell) const
+        {
+            cells->push_back((int)(&cell - base));
+        }
+    };
+
+    VoxelGrid<Discretizer, count_type> m_counts;
+    VoxelGrid<Discretizer> m_grid;
+
+    double m_translation_tolerance;
+    double m_rotation_tolerance;
+
+    std::vector<Object> m_objects;
+
+    bool needsUpdate(const Object& object) const;
+    void releaseCells(Object& object);
+    void acquireCells(Object& object);
+};
+
+template <class Discretizer>
+SceneVoxelizer<Discretizer>::SceneVoxelizer(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& size,
+    const Eigen::Vector3d& res,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc)
+:
+    m_counts(origin, size, res, x_disc, y_disc, z_disc),
+    m_grid(origin, size, res, x_disc, y_disc, z_disc),
+    m_translation_tolerance(0.0),
+    m_rotation_tolerance(0.0),
+    m_objects()
+{
+}
+
+template <class Discretizer>
+void SceneVoxelizer<Discretizer>::setTolerance(
+    double translation,
+    double rotation)
+{
+    m_translation_tolerance = translation;
+    m_rotation_tolerance = rotation;
+}
+
+template <class Discretizer>
+int SceneVoxelizer<Discretizer>::addObject(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    bool fill)
+{
+    Object object;
+    object.vertices = vertices;
+    object.indices = indices;
+    object.fill = fill;
+    object.pose = pose;
+    object.voxelized_pose = pose;
+    object.active = true;
+    object.voxelized = false;
+    m_objects.push_back(object);
+    return (int)m_objects.size() - 1;
+}
+
+template <class Discretizer>
+bool SceneVoxelizer<Discretizer>::setPose(int id, const Eigen::Affine3d& pose)
+{
+    if (id < 0 || id >= (int)m_objects.size() || !m_objects[id].active) {
+        std::cerr << "Invalid object id " << id << std::endl;
+        return false;
+    }
+    m_objects[id].pose = pose;
+    return true;
+}
+
+template <class Discretizer>
+bool SceneVoxelizer<Discretizer>::removeObject(int id)
+{
+    if (id < 0 || id >= (int)m_objects.size() || !m_objects[id].active) {
+        std::cerr << "Invalid object id " << id << std::endl;
+        return false;
+    }
+    Object& object = m_objects[id];
+    releaseCells(object);
+    object.active = false;
+    object.vertices.clear();
+    object.indices.clear();
+    return true;
+}
+
+template <class Discretizer>
+size_t SceneVoxelizer<Discretizer>::update()
+{
+    std::vector<int> moved;
+    for (int i = 0; i < (int)m_objects.size(); ++i) {
+        if (m_objects[i].active && needsUpdate(m_objects[i])) {
+            moved.push_back(i);
+        }
+    }
+
+    // voxelize the moved objects into new cell lists; the count grid is only
+    // used for its layout here, so this may proceed in parallel
+    std::vector<std::vector<int>> cells(moved.size());
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < (int)moved.size(); ++i) {
+        const Object& object = m_objects[moved[i]];
+        std::vector<Eigen::Vector3d> vertices(object.vertices.size());
+        for (size_t j = 0; j < vertices.size(); ++j) {
+            vertices[j] = object.pose * object.vertices[j];
+        }
+        RecordCell record = { m_counts.data(), &cells[i] };
+        VoxelizeMesh(vertices, object.indices, m_counts, record, object.fill);
+    }
+
+    for (size_t i = 0; i < moved.size(); ++i) {
+        Object& object = m_objects[moved[i]];
+        releaseCells(object);
+        object.cells.swap(cells[i]);
+        object.voxelized_pose = object.pose;
+        acquireCells(object);
+    }
+
+    return moved.size();
+}
+
+template <class Discretizer>
+bool SceneVoxelizer<Discretizer>::needsUpdate(const Object& object) const
+{
+    if (!object.voxelized) {
+        return true;
+    }
+
+    const Eigen::Vector3d dp =
+            object.pose.translation() - object.voxelized_pose.translation();
+    if (dp.norm() > m_translation_tolerance) {
+        return true;
+    }
+
+    const Eigen::Matrix3d dR = object.voxelized_pose.linear().transpose() *
+            object.pose.linear();
+    return Eigen::AngleAxisd(dR).angle() > m_rotation_tolerance;
+}
+
+template <class Discretizer>
+void SceneVoxelizer<Discretizer>::releaseCells(Object& object)
+{
+    if (!object.voxelized) {
+        return;
+    }
+    for (int idx : object.cells) {
+        if (--m_counts[MemoryIndex(idx)] == 0) {
+            m_grid[MemoryIndex(idx)] = 0;
+        }
+    }
+    object.cells.clear();
+    object.voxelized = false;
+}
+
+template <class Discretizer>
+void SceneVoxelizer<Discretizer>::acquireCells(Object& object)
+{
+    for (int idx : object.cells) {
+        if (m_counts[MemoryIndex(idx)]++ == 0) {
+            m_grid[MemoryIndex(idx)] = 1;
+        }
+    }
+    object.voxelized = true;
+}
+
+///////////////////////////
+// HalfResSceneVoxelizer //
+///////////////////////////
+
+class HalfResSceneVoxelizer : public SceneVoxelizer<HalfResDiscretizer>
+{
+public:
+
+    HalfResSceneVoxelizer(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res)
+    :
+        SceneVoxelizer(
+            origin, size, res,
+            HalfResDiscretizer(res.x()),
+            HalfResDiscretizer(res.y()),
+            HalfResDiscretizer(res.z()))
+    { }
+};
+
+/////////////////////////
+// PivotSceneVoxelizer //
+/////////////////////////
+
+class PivotSceneVoxelizer : public SceneVoxelizer<PivotDiscretizer>
+{
+public:
+
+    PivotSceneVoxelizer(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res,
+        const Eigen::Vector3d& pivot)
+    :
+        SceneVoxelizer(
+            origin, size, res,
+            PivotDiscretizer(res.x(), pivot.x()),
+            PivotDiscretizer(res.y(), pivot.y()),
+            PivotDiscretizer(res.z(), pivot.z()))
+    { }
+};
+
+} // namespace sbpl
+
+#endif
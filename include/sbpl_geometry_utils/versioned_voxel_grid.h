@@ -0,0 +1,509 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_versioned_voxel_grid_h
+#define sbpl_geometry_versioned_voxel_grid_h
+
+// standard includes
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+/// \brief Dense voxel grid that publishes immutable snapshots to concurrent
+///     readers
+///
+/// The grid is made up of BRICK_SIZE^3 bricks that are shared, by reference,
+/// between the writer and the snapshots it has published. A single writer
+/// updates the grid, i.e. via VoxelizeTriangle or VoxelizeStream, and calls
+/// publish() to make its contents visible; any number of readers call
+/// snapshot() to obtain the most recently published contents in O(1), and
+/// may keep reading a snapshot for as long as they hold it. The first write
+/// to a brick after a publish copies that brick, so the cost of an update is
+/// proportional to the number of bricks it modifies rather than to the size
+/// of the grid. Bricks that have never been written are not allocated and
+/// read as 0.
+///
+/// Like VoxelGrid, cells are not bounds checked; use isInBounds() to check
+/// grid coordinates.
+template <class Discretizer>
+class VersionedVoxelGrid : public VoxelGridBase
+{
+public:
+
+    typedef unsigned char value_type;
+
+    static const int BRICK_SIZE = 8;
+    static const int BRICK_CELL_COUNT = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+    struct Brick
+    {
+        std::uint64_t version; // version of the grid that created the brick
+        value_type cells[BRICK_CELL_COUNT];
+    };
+
+    class Snapshot;
+
+    VersionedVoxelGrid(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res,
+        const Discretizer& x_disc,
+        const Discretizer& y_disc,
+        const Discretizer& z_disc);
+
+    int sizeX() const { return m_layout.max_gc.x - m_layout.min_gc.x + 1; }
+    int sizeY() const { return m_layout.max_gc.y - m_layout.min_gc.y + 1; }
+    int sizeZ() const { return m_layout.max_gc.z - m_layout.min_gc.z + 1; }
+
+    const GridCoord& minGridCoord() const { return m_layout.min_gc; }
+    const GridCoord& maxGridCoord() const { return m_layout.max_gc; }
+
+    bool isInBounds(const GridCoord& coord) const;
+
+    /// \brief Return the version that the next call to publish() will publish
+    std::uint64_t version() const { return m_version; }
+
+    /// \brief Return the number of bricks allocated by the writer
+    size_t brickCount() const;
+
+    /// \brief Reset all cells to 0 without affecting published snapshots
+    void clear();
+
+    value_type& operator()(const GridCoord& coord);
+    value_type& operator()(const WorldCoord& coord);
+    value_type& operator[](const GridCoord& coord);
+    value_type& operator[](const WorldCoord& coord);
+
+    value_type operator()(const GridCoord& coord) const;
+    value_type operator()(const WorldCoord& coord) const;
+    value_type operator[](const GridCoord& coord) const;
+    value_type operator[](const WorldCoord& coord) const;
+
+    GridCoord worldToGrid(const WorldCoord& coord) const;
+    WorldCoord gridToWorld(const GridCoord& coord) const;
+
+    /// \brief Make the current contents of the grid visible to readers
+    std::shared_ptr<const Snapshot> publish();
+
+    /// \brief Return the most recently published snapshot, or null if
+    ///     nothing has been published; safe to call from any thread
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+private:
+
+    // brick arrangement and coordinate conversions shared with snapshots
+    struct Layout
+    {
+        GridCoord min_gc;
+        GridCoord max_gc;
+
+        Discretizer x_disc;
+        Discretizer y_disc;
+        Discretizer z_disc;
+
+        int bricks_x;
+        int bricks_y;
+        int bricks_z;
+
+        Layout(
+            const Eigen::Vector3d& origin,
+            const Eigen::Vector3d& size,
+            const Discretizer& x_disc,
+            const Discretizer& y_disc,
+            const Discretizer& z_disc);
+
+        bool isInBounds(const GridCoord& coord) const
+        {
+            return coord.x >= min_gc.x && coord.x <= max_gc.x &&
+                    coord.y >= min_gc.y && coord.y <= max_gc.y &&
+                    coord.z >= min_gc.z && coord.z <= max_gc.z;
+        }
+
+        int brickIndex(const GridCoord& coord) const
+        {
+            return (((coord.x - min_gc.x) / BRICK_SIZE) * bricks_y +
+                    (coord.y - min_gc.y) / BRICK_SIZE) * bricks_z +
+                    (coord.z - min_gc.z) / BRICK_SIZE;
+        }
+
+        int cellIndex(const GridCoord& coord) const
+        {
+            return (((coord.x - min_gc.x) % BRICK_SIZE) * BRICK_SIZE +
+                    (coord.y - min_gc.y) % BRICK_SIZE) * BRICK_SIZE +
+                    (coord.z - min_gc.z) % BRICK_SIZE;
+        }
+
+        GridCoord worldToGrid(const WorldCoord& coord) const
+        {
+            return GridCoord(
+                    x_disc.discretize(coord.x),
+                    y_disc.discretize(coord.y),
+                    z_disc.discretize(coord.z));
+        }
+
+        WorldCoord gridToWorld(const GridCoord& coord) const
+        {
+            return WorldCoord(
+                    x_disc.continuize(coord.x),
+                    y_disc.continuize(coord.y),
+                    z_disc.continuize(coord.z));
+        }
+    };
+
+    Layout m_layout;
+
+    // bricks with version == m_version were created since the last publish
+    // and are owned exclusively by the writer; all others may be shared with
+    // snapshots and are copied before being written
+    std::vector<std::shared_ptr<Brick>> m_bricks;
+    std::uint64_t m_version;
+
+    std::shared_ptr<const Snapshot> m_published;
+
+    value_type& writableCell(const GridCoord& coord);
+};
+
+/// \brief Immutable contents of a VersionedVoxelGrid at the time it was
+///     published
+template <class Discretizer>
+class VersionedVoxelGrid<Discretizer>::Snapshot : public VoxelGridBase
+{
+public:
+
+    std::uint64_t version() const { return m_version; }
+
+    int sizeX() const { return m_layout.max_gc.x - m_layout.min_gc.x + 1; }
+    int sizeY() const { return m_layout.max_gc.y - m_layout.min_gc.y + 1; }
+    int sizeZ() const { return m_layout.max_gc.z - m_layout.min_gc.z + 1; }
+
+    const GridCoord& minGridCoord() const { return m_layout.min_gc; }
+    const GridCoord& maxGridCoord() const { return m_layout.max_gc; }
+
+    bool isInBounds(const GridCoord& coord) const
+    {
+        return m_layout.isInBounds(coord);
+    }
+
+    value_type operator()(const GridCoord& coord) const;
+    value_type operator()(const WorldCoord& coord) const;
+    value_type operator[](const GridCoord& coord) const;
+    value_type operator[](const WorldCoord& coord) const;
+
+    GridCoord worldToGrid(const WorldCoord& coord) const
+    {
+        return m_layout.worldToGrid(coord);
+    }
+
+    WorldCoord gridToWorld(const GridCoord& coord) const
+    {
+        return m_layout.gridToWorld(coord);
+    }
+
+private:
+
+    friend class VersionedVoxelGrid;
+
+    Layout m_layout;
+    std::vector<std::shared_ptr<const Brick>> m_bricks;
+    std::uint64_t m_version;
+
+    Snapshot(const VersionedVoxelGrid& grid) :
+        VoxelGridBase(grid.origin(), grid.size(), grid.res()),
+        m_layout(grid.m_layout),
+        m_bricks(grid.m_bricks.begin(), grid.m_bricks.end()),
+        m_version(grid.m_version)
+    { }
+};
+
+template <class Discretizer>
+const int VersionedVoxelGrid<Discretizer>::BRICK_SIZE;
+
+template <class Discretizer>
+const int VersionedVoxelGrid<Discretizer>::BRICK_CELL_COUNT;
+
+template <class Discretizer>
+VersionedVoxelGrid<Discretizer>::Layout::Layout(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& size,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc)
+:
+    x_disc(x_disc),
+    y_disc(y_disc),
+    z_disc(z_disc)
+{
+    min_gc.x = x_disc.discretize(origin.x());
+    min_gc.y = y_disc.discretize(origin.y());
+    min_gc.z = z_disc.discretize(origin.z());
+
+    max_gc.x = x_disc.discretize(origin.x() + size.x());
+    max_gc.y = y_disc.discretize(origin.y() + size.y());
+    max_gc.z = z_disc.discretize(origin.z() + size.z());
+
+    bricks_x = (max_gc.x - min_gc.x + BRICK_SIZE) / BRICK_SIZE;
+    bricks_y = (max_gc.y - min_gc.y + BRICK_SIZE) / BRICK_SIZE;
+    bricks_z = (max_gc.z - min_gc.z + BRICK_SIZE) / BRICK_SIZE;
+}
+
+template <class Discretizer>
+VersionedVoxelGrid<Discretizer>::VersionedVoxelGrid(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& size,
+    const Eigen::Vector3d& res,
+    const Discretizer& x_disc,
+    const Discretizer& y_disc,
+    const Discretizer& z_disc)
+:
+    VoxelGridBase(origin, size, res),
+    m_layout(origin, size, x_disc, y_disc, z_disc),
+    m_bricks(),
+    m_version(1),
+    m_published()
+{
+    m_bricks.resize(
+            (size_t)m_layout.bricks_x * m_layout.bricks_y * m_layout.bricks_z);
+}
+
+template <class Discretizer>
+bool VersionedVoxelGrid<Discretizer>::isInBounds(const GridCoord& coord) const
+{
+    return m_layout.isInBounds(coord);
+}
+
+template <class Discretizer>
+size_t VersionedVoxelGrid<Discretizer>::brickCount() const
+{
+    return m_bricks.size() - std::count(
+            m_bricks.begin(), m_bricks.end(), std::shared_ptr<Brick>());
+}
+
+template <class Discretizer>
+void VersionedVoxelGrid<Discretizer>::clear()
+{
+    std::fill(m_bricks.begin(), m_bricks.end(), std::shared_ptr<Brick>());
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type&
+VersionedVoxelGrid<Discretizer>::writableCell(const GridCoord& coord)
+{
+    std::shared_ptr<Brick>& brick = m_bricks[m_layout.brickIndex(coord)];
+    if (!brick) {
+        brick = std::make_shared<Brick>();
+        brick->version = m_version;
+        std::fill(brick->cells, brick->cells + BRICK_CELL_COUNT, 0);
+    }
+    else if (brick->version != m_version) {
+        // the brick may be visible to readers; copy it before writing
+        brick = std::make_shared<Brick>(*brick);
+        brick->version = m_version;
+    }
+    return brick->cells[m_layout.cellIndex(coord)];
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type&
+VersionedVoxelGrid<Discretizer>::operator()(const GridCoord& coord)
+{
+    return writableCell(coord);
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type&
+VersionedVoxelGrid<Discretizer>::operator()(const WorldCoord& coord)
+{
+    return writableCell(worldToGrid(coord));
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type&
+VersionedVoxelGrid<Discretizer>::operator[](const GridCoord& coord)
+{
+    return writableCell(coord);
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type&
+VersionedVoxelGrid<Discretizer>::operator[](const WorldCoord& coord)
+{
+    return writableCell(worldToGrid(coord));
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type
+VersionedVoxelGrid<Discretizer>::operator()(const GridCoord& coord) const
+{
+    const std::shared_ptr<Brick>& brick = m_bricks[m_layout.brickIndex(coord)];
+    return brick ? brick->cells[m_layout.cellIndex(coord)] : 0;
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type
+VersionedVoxelGrid<Discretizer>::operator()(const WorldCoord& coord) const
+{
+    return (*this)(worldToGrid(coord));
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type
+VersionedVoxelGrid<Discretizer>::operator[](const GridCoord& coord) const
+{
+    return (*this)(coord);
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type
+VersionedVoxelGrid<Discretizer>::operator[](const WorldCoord& coord) const
+{
+    return (*this)(worldToGrid(coord));
+}
+
+template <class Discretizer>
+GridCoord
+VersionedVoxelGrid<Discretizer>::worldToGrid(const WorldCoord& coord) const
+{
+    return m_layout.worldToGrid(coord);
+}
+
+template <class Discretizer>
+WorldCoord
+VersionedVoxelGrid<Discretizer>::gridToWorld(const GridCoord& coord) const
+{
+    return m_layout.gridToWorld(coord);
+}
+
+template <class Discretizer>
+std::shared_ptr<const typename VersionedVoxelGrid<Discretizer>::Snapshot>
+VersionedVoxelGrid<Discretizer>::publish()
+{
+    std::shared_ptr<const Snapshot> snapshot(new Snapshot(*this));
+    std::atomic_store(&m_published, snapshot);
+
+    // bricks created from here on are not shared with any snapshot
+    ++m_version;
+    return snapshot;
+}
+
+template <class Discretizer>
+std::shared_ptr<const typename VersionedVoxelGrid<Discretizer>::Snapshot>
+VersionedVoxelGrid<Discretizer>::snapshot() const
+{
+    return std::atomic_load(&m_published);
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type
+VersionedVoxelGrid<Discretizer>::Snapshot::operator()(
+    const GridCoord& coord) const
+{
+    const std::shared_ptr<const Brick>& brick =
+            m_bricks[m_layout.brickIndex(coord)];
+    return brick ? brick->cells[m_layout.cellIndex(coord)] : 0;
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type
+VersionedVoxelGrid<Discretizer>::Snapshot::operator()(
+    const WorldCoord& coord) const
+{
+    return (*this)(worldToGrid(coord));
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type
+VersionedVoxelGrid<Discretizer>::Snapshot::operator[](
+    const GridCoord& coord) const
+{
+    return (*this)(coord);
+}
+
+template <class Discretizer>
+typename VersionedVoxelGrid<Discretizer>::value_type
+VersionedVoxelGrid<Discretizer>::Snapshot::operator[](
+    const WorldCoord& coord) const
+{
+    return (*this)(worldToGrid(coord));
+}
+
+///////////////////////////////
+// HalfResVersionedVoxelGrid //
+///////////////////////////////
+
+class HalfResVersionedVoxelGrid : public VersionedVoxelGrid<HalfResDiscretizer>
+{
+public:
+
+    HalfResVersionedVoxelGrid(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res)
+    :
+        VersionedVoxelGrid(
+            origin, size, res,
+            HalfResDiscretizer(res.x()),
+            HalfResDiscretizer(res.y()),
+            HalfResDiscretizer(res.z()))
+    { }
+};
+
+/////////////////////////////
+// PivotVersionedVoxelGrid //
+/////////////////////////////
+
+class PivotVersionedVoxelGrid : public VersionedVoxelGrid<PivotDiscretizer>
+{
+public:
+
+    PivotVersionedVoxelGrid(
+        const Eigen::Vector3d& origin,
+        const Eigen::Vector3d& size,
+        const Eigen::Vector3d& res,
+        const Eigen::Vector3d& pivot)
+    :
+        VersionedVoxelGrid(
+            origin, size, res,
+            PivotDiscretizer(res.x(), pivot.x()),
+            PivotDiscretizer(res.y(), pivot.y()),
+            PivotDiscretizer(res.z(), pivot.z()))
+    { }
+};
+
+} // namespace sbpl
+
+#endif
@@ -30,6 +30,15 @@
 #ifndef sbpl_geometry_voxel_grid_h
 #define sbpl_geometry_voxel_grid_h
 
+// standard includes
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
 #include <sbpl_geometry_utils/discretize.h>
 
 namespace sbpl {
@@ -76,8 +85,6 @@ class VoxelGridBase
 {
 public:
 
-    typedef unsigned char value_type;
-
     VoxelGridBase(
         const Eigen::Vector3d& origin,
         const Eigen::Vector3d& size,
@@ -97,17 +104,20 @@ protected:
     Eigen::Vector3d m_origin;
     Eigen::Vector3d m_size;
     Eigen::Vector3d m_res;
-
-    std::vector<value_type> m_grid;
 };
 
-template <class Discretizer>
+/// \brief A dense voxel grid
+///
+/// \tparam T The type of each cell. The default unsigned char is used as an
+///     occupancy flag by the voxelizers; other types can be used to store
+///     labels, counts, or costs written via a write policy.
+template <class Discretizer, typename T = unsigned char>
 class VoxelGrid : public VoxelGridBase
 {
 public:
 
     typedef VoxelGridBase Base;
-    typedef Base::value_type value_type;
+    typedef T value_type;
 
     VoxelGrid(
         const Eigen::Vector3d& origin,
@@ -121,6 +131,20 @@ public:
     int sizeY() const { return m_max_gc.y - m_min_gc.y + 1; }
     int sizeZ() const { return m_max_gc.z - m_min_gc.z + 1; }
 
+    const GridCoord& minGridCoord() const { return m_min_gc; }
+    const GridCoord& maxGridCoord() const { return m_max_gc; }
+
+    const Discretizer& xDiscretizer() const { return m_x_disc; }
+    const Discretizer& yDiscretizer() const { return m_y_disc; }
+    const Discretizer& zDiscretizer() const { return m_z_disc; }
+
+    bool isInBounds(const GridCoord& coord) const;
+
+    value_type* data() { return m_grid.data(); }
+    const value_type* data() const { return m_grid.data(); }
+
+    void assign(const value_type& value);
+
     value_type& operator()(const MemoryIndex& index);
     value_type& operator()(const MemoryCoord& coord);
     value_type& operator()(const GridCoord& coord);
@@ -160,10 +184,12 @@ protected:
     Discretizer m_x_disc;
     Discretizer m_y_disc;
     Discretizer m_z_disc;
+
+    std::vector<value_type> m_grid;
 };
 
-template <typename Discretizer>
-VoxelGrid<Discretizer>::VoxelGrid(
+template <typename Discretizer, typename T>
+VoxelGrid<Discretizer, T>::VoxelGrid(
     const Eigen::Vector3d& origin,
     const Eigen::Vector3d& size,
     const Eigen::Vector3d& res,
@@ -184,145 +210,159 @@ VoxelGrid<Discretizer>::VoxelGrid(
     m_max_gc.y = m_y_disc.discretize(origin.y() + size.y());
     m_max_gc.z = m_z_disc.discretize(origin.z() + size.z());
 
-    m_grid.resize(sizeX() * sizeY() * sizeZ(), false);
+    m_grid.resize(sizeX() * sizeY() * sizeZ(), value_type());
+}
+
+template <typename Discretizer, typename T>
+bool VoxelGrid<Discretizer, T>::isInBounds(const GridCoord& coord) const
+{
+    return coord.x >= m_min_gc.x && coord.x <= m_max_gc.x &&
+            coord.y >= m_min_gc.y && coord.y <= m_max_gc.y &&
+            coord.z >= m_min_gc.z && coord.z <= m_max_gc.z;
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type&
-VoxelGrid<Discretizer>::operator()(const MemoryIndex& index)
+template <typename Discretizer, typename T>
+void VoxelGrid<Discretizer, T>::assign(const value_type& value)
+{
+    std::fill(m_grid.begin(), m_grid.end(), value);
+}
+
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type&
+VoxelGrid<Discretizer, T>::operator()(const MemoryIndex& index)
 {
     return m_grid[index.idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type&
-VoxelGrid<Discretizer>::operator()(const MemoryCoord& coord)
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type&
+VoxelGrid<Discretizer, T>::operator()(const MemoryCoord& coord)
 {
     return m_grid[memoryToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type&
-VoxelGrid<Discretizer>::operator()(const GridCoord& coord)
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type&
+VoxelGrid<Discretizer, T>::operator()(const GridCoord& coord)
 {
     return m_grid[gridToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type&
-VoxelGrid<Discretizer>::operator()(const WorldCoord& coord)
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type&
+VoxelGrid<Discretizer, T>::operator()(const WorldCoord& coord)
 {
     return m_grid[worldToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type&
-VoxelGrid<Discretizer>::operator[](const MemoryIndex& index)
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type&
+VoxelGrid<Discretizer, T>::operator[](const MemoryIndex& index)
 {
     return m_grid[index.idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type&
-VoxelGrid<Discretizer>::operator[](const MemoryCoord& coord)
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type&
+VoxelGrid<Discretizer, T>::operator[](const MemoryCoord& coord)
 {
     return m_grid[memoryToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type&
-VoxelGrid<Discretizer>::operator[](const GridCoord& coord)
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type&
+VoxelGrid<Discretizer, T>::operator[](const GridCoord& coord)
 {
     return m_grid[gridToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type&
-VoxelGrid<Discretizer>::operator[](const WorldCoord& coord)
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type&
+VoxelGrid<Discretizer, T>::operator[](const WorldCoord& coord)
 {
     return m_grid[worldToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type
-VoxelGrid<Discretizer>::operator()(const MemoryIndex& index) const
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type
+VoxelGrid<Discretizer, T>::operator()(const MemoryIndex& index) const
 {
     return m_grid[index.idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type
-VoxelGrid<Discretizer>::operator()(const MemoryCoord& coord) const
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type
+VoxelGrid<Discretizer, T>::operator()(const MemoryCoord& coord) const
 {
     return m_grid[memoryToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type
-VoxelGrid<Discretizer>::operator()(const GridCoord& coord) const
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type
+VoxelGrid<Discretizer, T>::operator()(const GridCoord& coord) const
 {
     return m_grid[gridToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type
-VoxelGrid<Discretizer>::operator()(const WorldCoord& coord) const
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type
+VoxelGrid<Discretizer, T>::operator()(const WorldCoord& coord) const
 {
     return m_grid[worldToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type
-VoxelGrid<Discretizer>::operator[](const MemoryIndex& index) const
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type
+VoxelGrid<Discretizer, T>::operator[](const MemoryIndex& index) const
 {
     return m_grid[index.idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type
-VoxelGrid<Discretizer>::operator[](const MemoryCoord& coord) const
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type
+VoxelGrid<Discretizer, T>::operator[](const MemoryCoord& coord) const
 {
     return m_grid[memoryToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type
-VoxelGrid<Discretizer>::operator[](const GridCoord& coord) const
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type
+VoxelGrid<Discretizer, T>::operator[](const GridCoord& coord) const
 {
     return m_grid[gridToIndex(coord).idx];
 }
 
-template <typename Discretizer>
-typename VoxelGrid<Discretizer>::value_type
-VoxelGrid<Discretizer>::operator[](const WorldCoord& coord) const
+template <typename Discretizer, typename T>
+typename VoxelGrid<Discretizer, T>::value_type
+VoxelGrid<Discretizer, T>::operator[](const WorldCoord& coord) const
 {
     return m_grid[worldToIndex(coord).idx];
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 MemoryIndex
-VoxelGrid<Discretizer>::memoryToIndex(const MemoryCoord& coord) const
+VoxelGrid<Discretizer, T>::memoryToIndex(const MemoryCoord& coord) const
 {
     return MemoryIndex(coord.x * sizeY() * sizeZ() + coord.y * sizeZ() + coord.z);
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 MemoryIndex
-VoxelGrid<Discretizer>::gridToIndex(const GridCoord& coord) const
+VoxelGrid<Discretizer, T>::gridToIndex(const GridCoord& coord) const
 {
     return memoryToIndex(gridToMemory(coord));
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 MemoryIndex
-VoxelGrid<Discretizer>::worldToIndex(const WorldCoord& coord) const
+VoxelGrid<Discretizer, T>::worldToIndex(const WorldCoord& coord) const
 {
-    return memoryToIndex(gridToMemory(worldToGrid()));
+    return memoryToIndex(gridToMemory(worldToGrid(coord)));
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 MemoryCoord
-VoxelGrid<Discretizer>::indexToMemory(const MemoryIndex& index) const
+VoxelGrid<Discretizer, T>::indexToMemory(const MemoryIndex& index) const
 {
     int x = index.idx / (sizeZ() * sizeY());
     int y = (index.idx - x * (sizeZ() * sizeY())) / sizeZ();
@@ -330,9 +370,9 @@ VoxelGrid<Discretizer>::indexToMemory(const MemoryIndex& index) const
     return MemoryCoord(x, y, z);
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 MemoryCoord
-VoxelGrid<Discretizer>::gridToMemory(const GridCoord& coord) const
+VoxelGrid<Discretizer, T>::gridToMemory(const GridCoord& coord) const
 {
     const int x = coord.x - m_min_gc.x;
     const int y = coord.y - m_min_gc.y;
@@ -340,23 +380,23 @@ VoxelGrid<Discretizer>::gridToMemory(const GridCoord& coord) const
     return MemoryCoord(x, y, z);
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 MemoryCoord
-VoxelGrid<Discretizer>::worldToMemory(const WorldCoord& coord) const
+VoxelGrid<Discretizer, T>::worldToMemory(const WorldCoord& coord) const
 {
     return gridToMemory(worldToGrid(coord));
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 GridCoord
-VoxelGrid<Discretizer>::indexToGrid(const MemoryIndex& index) const
+VoxelGrid<Discretizer, T>::indexToGrid(const MemoryIndex& index) const
 {
     return memoryToGrid(indexToMemory(index));
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 GridCoord
-VoxelGrid<Discretizer>::memoryToGrid(const MemoryCoord& coord) const
+VoxelGrid<Discretizer, T>::memoryToGrid(const MemoryCoord& coord) const
 {
     int x = m_min_gc.x + coord.x;
     int y = m_min_gc.y + coord.y;
@@ -364,9 +404,9 @@ VoxelGrid<Discretizer>::memoryToGrid(const MemoryCoord& coord) const
     return GridCoord(x, y, z);
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 GridCoord
-VoxelGrid<Discretizer>::worldToGrid(const WorldCoord& coord) const
+VoxelGrid<Discretizer, T>::worldToGrid(const WorldCoord& coord) const
 {
     return GridCoord(
             m_x_disc.discretize(coord.x),
@@ -374,23 +414,23 @@ VoxelGrid<Discretizer>::worldToGrid(const WorldCoord& coord) const
             m_z_disc.discretize(coord.z));
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 WorldCoord
-VoxelGrid<Discretizer>::indexToWorld(const MemoryIndex& index) const
+VoxelGrid<Discretizer, T>::indexToWorld(const MemoryIndex& index) const
 {
     return gridToWorld(indexToGrid(index));
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 WorldCoord
-VoxelGrid<Discretizer>::memoryToWorld(const MemoryCoord& coord) const
+VoxelGrid<Discretizer, T>::memoryToWorld(const MemoryCoord& coord) const
 {
     return gridToWorld(memoryToGrid(coord));
 }
 
-template <typename Discretizer>
+template <typename Discretizer, typename T>
 WorldCoord
-VoxelGrid<Discretizer>::gridToWorld(const GridCoord& coord) const
+VoxelGrid<Discretizer, T>::gridToWorld(const GridCoord& coord) const
 {
     const double x = m_x_disc.continuize(coord.x);
     const double y = m_y_disc.continuize(coord.y);
@@ -398,6 +438,139 @@ VoxelGrid<Discretizer>::gridToWorld(const GridCoord& coord) const
     return WorldCoord(x, y, z);
 }
 
+////////////////////
+// Write Policies //
+////////////////////
+
+/// \brief Write policy that marks cells as occupied
+struct SetFlag
+{
+    template <typename T>
+    void operator()(T& cell) const { cell = T(1); }
+};
+
+/// \brief Write policy that overwrites cells with an object label
+template <typename T>
+struct WriteLabel
+{
+    T label;
+
+    explicit WriteLabel(const T& label) : label(label) { }
+
+    void operator()(T& cell) const { cell = label; }
+};
+
+/// \brief Write policy that counts the objects occupying each cell, saturating
+///     at the maximum value of the cell type
+struct SaturatingIncrement
+{
+    template <typename T>
+    void operator()(T& cell) const
+    {
+        if (cell < std::numeric_limits<T>::max()) {
+            ++cell;
+        }
+    }
+};
+
+/// \brief Write policy that keeps the minimum cost written to each cell
+///
+/// The grid should be initialized to a large cost beforehand, i.e. via
+/// VoxelGrid::assign(std::numeric_limits<T>::max()).
+template <typename T>
+struct MinCost
+{
+    T cost;
+
+    explicit MinCost(const T& cost) : cost(cost) { }
+
+    void operator()(T& cell) const
+    {
+        if (cost < cell) {
+            cell = cost;
+        }
+    }
+};
+
+// The following policies may be used by multiple threads writing into the
+// same grid concurrently, i.e. from concurrent calls to the write policy
+// overload of VoxelizeMesh. Each is commutative, so the final contents of the
+// grid do not depend on the order in which the threads write.
+
+/// \brief Write policy that marks cells as occupied with relaxed atomic stores
+struct AtomicSetFlag
+{
+    template <typename T>
+    void operator()(T& cell) const
+    {
+        T one(1);
+        __atomic_store(&cell, &one, __ATOMIC_RELAXED);
+    }
+};
+
+/// \brief Write policy that keeps the largest object label written to each
+///     cell
+template <typename T>
+struct AtomicMaxLabel
+{
+    T label;
+
+    explicit AtomicMaxLabel(const T& label) : label(label) { }
+
+    void operator()(T& cell) const
+    {
+        T prev;
+        __atomic_load(&cell, &prev, __ATOMIC_RELAXED);
+        while (prev < label &&
+            !__atomic_compare_exchange(
+                    &cell, &prev, &label, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        { }
+    }
+};
+
+/// \brief Write policy that atomically counts the objects occupying each cell,
+///     saturating at the maximum value of the cell type
+struct AtomicSaturatingIncrement
+{
+    template <typename T>
+    void operator()(T& cell) const
+    {
+        T prev;
+        __atomic_load(&cell, &prev, __ATOMIC_RELAXED);
+        while (prev < std::numeric_limits<T>::max()) {
+            T next = prev + 1;
+            if (__atomic_compare_exchange(
+                    &cell, &prev, &next, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+    }
+};
+
+/// \brief Write policy that atomically keeps the minimum cost written to each
+///     cell
+template <typename T>
+struct AtomicMinCost
+{
+    T cost;
+
+    explicit AtomicMinCost(const T& cost) : cost(cost) { }
+
+    void operator()(T& cell) const
+    {
+        T prev;
+        __atomic_load(&cell, &prev, __ATOMIC_RELAXED);
+        while (cost < prev &&
+            !__atomic_compare_exchange(
+                    &cell, &prev, &cost, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        { }
+    }
+};
+
 //////////////////////
 // MinDiscVoxelGrid //
 //////////////////////
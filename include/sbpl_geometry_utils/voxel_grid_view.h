@@ -0,0 +1,384 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_voxel_grid_view_h
+#define sbpl_geometry_voxel_grid_view_h
+
+// standard includes
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+/// \brief Non-owning view of a box of cells of a VoxelGrid
+///
+/// The view references the cells of its grid in place: its z-rows are
+/// contiguous and its rows and slices are strided by those of the grid. Grid
+/// and world coordinates are those of the grid; memory coordinates are
+/// relative to the lower corner of the view. Like a pointer, a view does not
+/// propagate its own constness to the cells; a view of a const grid has type
+/// VoxelGridView<Discretizer, const T>. The view is invalidated if the grid is
+/// destroyed or reassigned.
+template <class Discretizer, typename T = unsigned char>
+class VoxelGridView
+{
+public:
+
+    typedef typename std::remove_const<T>::type value_type;
+    typedef VoxelGrid<Discretizer, value_type> grid_type;
+    typedef typename std::conditional<
+            std::is_const<T>::value, const grid_type, grid_type>::type
+            parent_type;
+
+    /// \brief Construct a view of an entire grid
+    explicit VoxelGridView(parent_type& grid);
+
+    /// \brief Construct a view of the cells of a grid between two grid
+    ///     coordinates, inclusive, clipped to the extents of the grid
+    VoxelGridView(
+        parent_type& grid,
+        const GridCoord& min,
+        const GridCoord& max);
+
+    parent_type& grid() const { return *m_grid; }
+
+    bool empty() const { return sizeX() == 0 || sizeY() == 0 || sizeZ() == 0; }
+
+    int sizeX() const { return std::max(0, m_max_gc.x - m_min_gc.x + 1); }
+    int sizeY() const { return std::max(0, m_max_gc.y - m_min_gc.y + 1); }
+    int sizeZ() const { return std::max(0, m_max_gc.z - m_min_gc.z + 1); }
+
+    const GridCoord& minGridCoord() const { return m_min_gc; }
+    const GridCoord& maxGridCoord() const { return m_max_gc; }
+
+    const Eigen::Vector3d& res() const { return m_grid->res(); }
+
+    const Discretizer& xDiscretizer() const { return m_grid->xDiscretizer(); }
+    const Discretizer& yDiscretizer() const { return m_grid->yDiscretizer(); }
+    const Discretizer& zDiscretizer() const { return m_grid->zDiscretizer(); }
+
+    bool isInBounds(const GridCoord& coord) const;
+
+    /// \brief Return a pointer to the contiguous row of sizeZ() cells at a
+    ///     memory coordinate of the view
+    T* row(int x, int y) const
+    {
+        return m_data + x * m_stride_x + y * m_stride_y;
+    }
+
+    int strideX() const { return m_stride_x; }
+    int strideY() const { return m_stride_y; }
+
+    void assign(const value_type& value) const;
+
+    T& operator()(const MemoryCoord& coord) const;
+    T& operator()(const GridCoord& coord) const;
+    T& operator()(const WorldCoord& coord) const;
+    T& operator[](const MemoryCoord& coord) const;
+    T& operator[](const GridCoord& coord) const;
+    T& operator[](const WorldCoord& coord) const;
+
+    MemoryCoord gridToMemory(const GridCoord& coord) const;
+    MemoryCoord worldToMemory(const WorldCoord& coord) const;
+    GridCoord   memoryToGrid(const MemoryCoord& coord) const;
+    GridCoord   worldToGrid(const WorldCoord& coord) const;
+    WorldCoord  memoryToWorld(const MemoryCoord& coord) const;
+    WorldCoord  gridToWorld(const GridCoord& coord) const;
+
+private:
+
+    parent_type* m_grid;
+
+    GridCoord m_min_gc;
+    GridCoord m_max_gc;
+
+    T* m_data; // the cell at the lower corner of the view
+    int m_stride_x;
+    int m_stride_y;
+};
+
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, T> MakeView(VoxelGrid<Discretizer, T>& grid);
+
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, const T> MakeView(
+    const VoxelGrid<Discretizer, T>& grid);
+
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, T> MakeView(
+    VoxelGrid<Discretizer, T>& grid,
+    const GridCoord& min,
+    const GridCoord& max);
+
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, const T> MakeView(
+    const VoxelGrid<Discretizer, T>& grid,
+    const GridCoord& min,
+    const GridCoord& max);
+
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, T> MakeView(
+    VoxelGrid<Discretizer, T>& grid,
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max);
+
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, const T> MakeView(
+    const VoxelGrid<Discretizer, T>& grid,
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max);
+
+template <typename Discretizer, typename T>
+void ExtractVoxels(
+    const VoxelGridView<Discretizer, T>& view,
+    std::vector<Eigen::Vector3d>& voxels);
+
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, T>::VoxelGridView(parent_type& grid) :
+    VoxelGridView(grid, grid.minGridCoord(), grid.maxGridCoord())
+{
+}
+
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, T>::VoxelGridView(
+    parent_type& grid,
+    const GridCoord& min,
+    const GridCoord& max)
+:
+    m_grid(&grid),
+    m_min_gc(
+        std::max(min.x, grid.minGridCoord().x),
+        std::max(min.y, grid.minGridCoord().y),
+        std::max(min.z, grid.minGridCoord().z)),
+    m_max_gc(
+        std::min(max.x, grid.maxGridCoord().x),
+        std::min(max.y, grid.maxGridCoord().y),
+        std::min(max.z, grid.maxGridCoord().z)),
+    m_data(grid.data()),
+    m_stride_x(grid.sizeY() * grid.sizeZ()),
+    m_stride_y(grid.sizeZ())
+{
+    if (!empty()) {
+        m_data += grid.gridToIndex(m_min_gc).idx;
+    }
+}
+
+template <typename Discretizer, typename T>
+bool VoxelGridView<Discretizer, T>::isInBounds(const GridCoord& coord) const
+{
+    return coord.x >= m_min_gc.x && coord.x <= m_max_gc.x &&
+            coord.y >= m_min_gc.y && coord.y <= m_max_gc.y &&
+            coord.z >= m_min_gc.z && coord.z <= m_max_gc.z;
+}
+
+template <typename Discretizer, typename T>
+void VoxelGridView<Discretizer, T>::assign(const value_type& value) const
+{
+    for (int x = 0; x < sizeX(); ++x) {
+        for (int y = 0; y < sizeY(); ++y) {
+            T* r = row(x, y);
+            std::fill(r, r + sizeZ(), value);
+        }
+    }
+}
+
+template <typename Discretizer, typename T>
+T& VoxelGridView<Discretizer, T>::operator()(const MemoryCoord& coord) const
+{
+    return row(coord.x, coord.y)[coord.z];
+}
+
+template <typename Discretizer, typename T>
+T& VoxelGridView<Discretizer, T>::operator()(const GridCoord& coord) const
+{
+    return (*this)(gridToMemory(coord));
+}
+
+template <typename Discretizer, typename T>
+T& VoxelGridView<Discretizer, T>::operator()(const WorldCoord& coord) const
+{
+    return (*this)(worldToMemory(coord));
+}
+
+template <typename Discretizer, typename T>
+T& VoxelGridView<Discretizer, T>::operator[](const MemoryCoord& coord) const
+{
+    return (*this)(coord);
+}
+
+template <typename Discretizer, typename T>
+T& VoxelGridView<Discretizer, T>::operator[](const GridCoord& coord) const
+{
+    return (*this)(gridToMemory(coord));
+}
+
+template <typename Discretizer, typename T>
+T& VoxelGridView<Discretizer, T>::operator[](const WorldCoord& coord) const
+{
+    return (*this)(worldToMemory(coord));
+}
+
+template <typename Discretizer, typename T>
+MemoryCoord
+VoxelGridView<Discretizer, T>::gridToMemory(const GridCoord& coord) const
+{
+    return MemoryCoord(
+            coord.x - m_min_gc.x, coord.y - m_min_gc.y, coord.z - m_min_gc.z);
+}
+
+template <typename Discretizer, typename T>
+MemoryCoord
+VoxelGridView<Discretizer, T>::worldToMemory(const WorldCoord& coord) const
+{
+    return gridToMemory(worldToGrid(coord));
+}
+
+template <typename Discretizer, typename T>
+GridCoord
+VoxelGridView<Discretizer, T>::memoryToGrid(const MemoryCoord& coord) const
+{
+    return GridCoord(
+            coord.x + m_min_gc.x, coord.y + m_min_gc.y, coord.z + m_min_gc.z);
+}
+
+template <typename Discretizer, typename T>
+GridCoord
+VoxelGridView<Discretizer, T>::worldToGrid(const WorldCoord& coord) const
+{
+    return m_grid->worldToGrid(coord);
+}
+
+template <typename Discretizer, typename T>
+WorldCoord
+VoxelGridView<Discretizer, T>::memoryToWorld(const MemoryCoord& coord) const
+{
+    return m_grid->gridToWorld(memoryToGrid(coord));
+}
+
+template <typename Discretizer, typename T>
+WorldCoord
+VoxelGridView<Discretizer, T>::gridToWorld(const GridCoord& coord) const
+{
+    return m_grid->gridToWorld(coord);
+}
+
+/// \brief Return a view of an entire grid
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, T> MakeView(VoxelGrid<Discretizer, T>& grid)
+{
+    return VoxelGridView<Discretizer, T>(grid);
+}
+
+/// \brief Return a read-only view of an entire grid
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, const T> MakeView(
+    const VoxelGrid<Discretizer, T>& grid)
+{
+    return VoxelGridView<Discretizer, const T>(grid);
+}
+
+/// \brief Return a view of the cells of a grid between two grid coordinates
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, T> MakeView(
+    VoxelGrid<Discretizer, T>& grid,
+    const GridCoord& min,
+    const GridCoord& max)
+{
+    return VoxelGridView<Discretizer, T>(grid, min, max);
+}
+
+/// \brief Return a read-only view of the cells of a grid between two grid
+///     coordinates
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, const T> MakeView(
+    const VoxelGrid<Discretizer, T>& grid,
+    const GridCoord& min,
+    const GridCoord& max)
+{
+    return VoxelGridView<Discretizer, const T>(grid, min, max);
+}
+
+/// \brief Return a view of the cells of a grid within a world-frame box
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, T> MakeView(
+    VoxelGrid<Discretizer, T>& grid,
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max)
+{
+    return VoxelGridView<Discretizer, T>(
+            grid,
+            grid.worldToGrid(WorldCoord(min.x(), min.y(), min.z())),
+            grid.worldToGrid(WorldCoord(max.x(), max.y(), max.z())));
+}
+
+/// \brief Return a read-only view of the cells of a grid within a world-frame
+///     box
+template <typename Discretizer, typename T>
+VoxelGridView<Discretizer, const T> MakeView(
+    const VoxelGrid<Discretizer, T>& grid,
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max)
+{
+    return VoxelGridView<Discretizer, const T>(
+            grid,
+            grid.worldToGrid(WorldCoord(min.x(), min.y(), min.z())),
+            grid.worldToGrid(WorldCoord(max.x(), max.y(), max.z())));
+}
+
+/// \brief Append the centers of all occupied cells of a view to a vector of
+///     voxels
+template <typename Discretizer, typename T>
+void ExtractVoxels(
+    const VoxelGridView<Discretizer, T>& view,
+    std::vector<Eigen::Vector3d>& voxels)
+{
+    for (int x = 0; x < view.sizeX(); ++x) {
+        for (int y = 0; y < view.sizeY(); ++y) {
+            const T* row = view.row(x, y);
+            for (int z = 0; z < view.sizeZ(); ++z) {
+                if (row[z]) {
+                    const WorldCoord wc =
+                            view.memoryToWorld(MemoryCoord(x, y, z));
+                    voxels.push_back(Eigen::Vector3d(wc.x, wc.y, wc.z));
+                }
+            }
+        }
+    }
+}
+
+} // namespace sbpl
+
+#endif
@@ -0,0 +1,352 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_voxel_key_h
+#define sbpl_geometry_voxel_key_h
+
+// standard includes
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+/// \brief Grid coordinate packed into a single 64-bit integer
+///
+/// Each axis is stored in 21 bits, offset so that coordinates in
+/// [MIN_COORD, MAX_COORD] are representable, with x in the most significant
+/// bits and z in the least. Keys therefore compare in the same order as the
+/// memory layout of a VoxelGrid, and two voxels produced on the same lattice
+/// share a key exactly when they are the same cell.
+class VoxelKey
+{
+public:
+
+    static const int BITS_PER_AXIS = 21;
+    static const int MIN_COORD = -(1 << (BITS_PER_AXIS - 1));
+    static const int MAX_COORD = (1 << (BITS_PER_AXIS - 1)) - 1;
+
+    VoxelKey() : m_value() { }
+
+    VoxelKey(int x, int y, int z) : m_value(Pack(x, y, z)) {
+        assert(IsRepresentable(GridCoord(x, y, z)));
+    }
+
+    explicit VoxelKey(const GridCoord& gc) : m_value(Pack(gc.x, gc.y, gc.z)) {
+        assert(IsRepresentable(gc));
+    }
+
+    explicit VoxelKey(std::uint64_t value) : m_value(value) { }
+
+    static bool IsRepresentable(const GridCoord& gc) {
+        return gc.x >= MIN_COORD && gc.x <= MAX_COORD &&
+                gc.y >= MIN_COORD && gc.y <= MAX_COORD &&
+                gc.z >= MIN_COORD && gc.z <= MAX_COORD;
+    }
+
+    int x() const { return Unpack(m_value >> (2 * BITS_PER_AXIS)); }
+    int y() const { return Unpack(m_value >> BITS_PER_AXIS); }
+    int z() const { return Unpack(m_value); }
+
+    GridCoord gridCoord() const { return GridCoord(x(), y(), z()); }
+
+    std::uint64_t value() const { return m_value; }
+
+    bool operator==(const VoxelKey& o) const { return m_value == o.m_value; }
+    bool operator!=(const VoxelKey& o) const { return m_value != o.m_value; }
+    bool operator<(const VoxelKey& o) const { return m_value < o.m_value; }
+
+private:
+
+    static const std::uint64_t AXIS_MASK = (1ULL << BITS_PER_AXIS) - 1;
+
+    std::uint64_t m_value;
+
+    static std::uint64_t Pack(int x, int y, int z) {
+        return (std::uint64_t)(x - MIN_COORD) << (2 * BITS_PER_AXIS) |
+                (std::uint64_t)(y - MIN_COORD) << BITS_PER_AXIS |
+                (std::uint64_t)(z - MIN_COORD);
+    }
+
+    static int Unpack(std::uint64_t bits) {
+        return (int)(bits & AXIS_MASK) + MIN_COORD;
+    }
+};
+
+/// \brief Hash set of voxel keys using open addressing
+///
+/// Keys are stored directly in a flat, power-of-two sized table and probed
+/// linearly from a multiplicative hash of the packed key. The table is kept at
+/// most half full and never holds more than the keys themselves, so lookups
+/// usually touch a single cache line.
+class VoxelKeySet
+{
+public:
+
+    class const_iterator
+    {
+    public:
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef VoxelKey value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const VoxelKey* pointer;
+        typedef VoxelKey reference;
+
+        const_iterator() : m_slot(nullptr), m_end(nullptr) { }
+
+        VoxelKey operator*() const { return VoxelKey(*m_slot); }
+
+        const_iterator& operator++() {
+            ++m_slot;
+            skipEmpty();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator it(*this);
+            ++(*this);
+            return it;
+        }
+
+        bool operator==(const const_iterator& o) const { return m_slot == o.m_slot; }
+        bool operator!=(const const_iterator& o) const { return m_slot != o.m_slot; }
+
+    private:
+
+        friend class VoxelKeySet;
+
+        const std::uint64_t* m_slot;
+        const std::uint64_t* m_end;
+
+        const_iterator(const std::uint64_t* slot, const std::uint64_t* end) :
+            m_slot(slot), m_end(end)
+        {
+            skipEmpty();
+        }
+
+        void skipEmpty() {
+            while (m_slot != m_end && *m_slot == EMPTY_SLOT) {
+                ++m_slot;
+            }
+        }
+    };
+
+    VoxelKeySet() : m_slots(), m_size(0), m_shift(64) { }
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_slots.size(); }
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    void clear();
+    void reserve(size_t count);
+
+    bool insert(const VoxelKey& key);
+    bool erase(const VoxelKey& key);
+    bool contains(const VoxelKey& key) const;
+    size_t count(const VoxelKey& key) const { return contains(key) ? 1 : 0; }
+
+private:
+
+    enum : std::uint64_t
+    {
+        // no key has its most significant bit set
+        EMPTY_SLOT = ~0ULL,
+        MIN_CAPACITY = 16
+    };
+
+    std::vector<std::uint64_t> m_slots;
+    size_t m_size;
+    int m_shift;
+
+    size_t slotIndex(std::uint64_t value) const {
+        return (size_t)((value * 0x9E3779B97F4A7C15ULL) >> m_shift);
+    }
+
+    void rehash(size_t capacity);
+};
+
+void ExtractVoxelKeys(
+    const VoxelKeySet& set,
+    std::vector<VoxelKey>& keys);
+
+inline VoxelKeySet::const_iterator VoxelKeySet::begin() const
+{
+    return const_iterator(m_slots.data(), m_slots.data() + m_slots.size());
+}
+
+inline VoxelKeySet::const_iterator VoxelKeySet::end() const
+{
+    const std::uint64_t* end = m_slots.data() + m_slots.size();
+    return const_iterator(end, end);
+}
+
+inline void VoxelKeySet::clear()
+{
+    std::fill(m_slots.begin(), m_slots.end(), EMPTY_SLOT);
+    m_size = 0;
+}
+
+/// \brief Grow the table so that it may hold count keys without rehashing
+inline void VoxelKeySet::reserve(size_t count)
+{
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < 2 * count) {
+        capacity <<= 1;
+    }
+    if (capacity > m_slots.size()) {
+        rehash(capacity);
+    }
+}
+
+/// \brief Insert a key into the set
+/// \return Whether the key was not already in the set
+inline bool VoxelKeySet::insert(const VoxelKey& key)
+{
+    if (2 * (m_size + 1) > m_slots.size()) {
+        rehash(m_slots.empty() ? MIN_CAPACITY : 2 * m_slots.size());
+    }
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = slotIndex(key.value()); ; i = (i + 1) & mask) {
+        if (m_slots[i] == key.value()) {
+            return false;
+        }
+        if (m_slots[i] == EMPTY_SLOT) {
+            m_slots[i] = key.value();
+            ++m_size;
+            return true;
+        }
+    }
+}
+
+/// \brief Remove a key from the set
+///
+/// Keys following the removed key in its probe sequence are shifted back into
+/// the vacated slot where their own probe sequences allow, so that no
+/// tombstones are left behind.
+/// \return Whether the key was in the set
+inline bool VoxelKeySet::erase(const VoxelKey& key)
+{
+    if (m_size == 0) {
+        return false;
+    }
+
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = slotIndex(key.value());
+    while (m_slots[hole] != key.value()) {
+        if (m_slots[hole] == EMPTY_SLOT) {
+            return false;
+        }
+        hole = (hole + 1) & mask;
+    }
+
+    for (size_t i = (hole + 1) & mask; m_slots[i] != EMPTY_SLOT; i = (i + 1) & mask) {
+        // move the key back if its home slot does not lie in (hole, i]
+        const size_t home = slotIndex(m_slots[i]);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            m_slots[hole] = m_slots[i];
+            hole = i;
+        }
+    }
+    m_slots[hole] = EMPTY_SLOT;
+    --m_size;
+    return true;
+}
+
+inline bool VoxelKeySet::contains(const VoxelKey& key) const
+{
+    if (m_size == 0) {
+        return false;
+    }
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = slotIndex(key.value()); ; i = (i + 1) & mask) {
+        if (m_slots[i] == key.value()) {
+            return true;
+        }
+        if (m_slots[i] == EMPTY_SLOT) {
+            return false;
+        }
+    }
+}
+
+inline void VoxelKeySet::rehash(size_t capacity)
+{
+    std::vector<std::uint64_t> slots(capacity, EMPTY_SLOT);
+    m_slots.swap(slots);
+    m_shift = 64 - __builtin_ctzll(capacity);
+
+    const size_t mask = capacity - 1;
+    for (std::uint64_t value : slots) {
+        if (value != EMPTY_SLOT) {
+            size_t i = slotIndex(value);
+            while (m_slots[i] != EMPTY_SLOT) {
+                i = (i + 1) & mask;
+            }
+            m_slots[i] = value;
+        }
+    }
+}
+
+/// \brief Append the keys of a set to a vector of keys, in increasing order
+inline void ExtractVoxelKeys(
+    const VoxelKeySet& set,
+    std::vector<VoxelKey>& keys)
+{
+    const size_t base = keys.size();
+    keys.insert(keys.end(), set.begin(), set.end());
+    std::sort(keys.begin() + base, keys.end());
+}
+
+} // namespace sbpl
+
+namespace std {
+
+template <>
+struct hash<sbpl::VoxelKey>
+{
+    size_t operator()(const sbpl::VoxelKey& key) const {
+        return std::hash<std::uint64_t>()(key.value());
+    }
+};
+
+} // namespace std
+
+#endif
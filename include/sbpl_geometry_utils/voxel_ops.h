@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_voxel_ops_h
+#define sbpl_geometry_voxel_ops_h
+
+// project includes
+#include <sbpl_geometry_utils/voxel_grid.h>
+#include <sbpl_geometry_utils/voxel_grid_view.h>
+
+namespace sbpl {
+
+// In-place boolean operations; the result is stored in a.
+template <typename Discretizer>
+bool UnionVoxels(VoxelGrid<Discretizer>& a, const VoxelGrid<Discretizer>& b);
+
+template <typename Discretizer>
+bool IntersectVoxels(VoxelGrid<Discretizer>& a, const VoxelGrid<Discretizer>& b);
+
+template <typename Discretizer>
+bool SubtractVoxels(VoxelGrid<Discretizer>& a, const VoxelGrid<Discretizer>& b);
+
+template <typename Discretizer>
+bool XorVoxels(VoxelGrid<Discretizer>& a, const VoxelGrid<Discretizer>& b);
+
+// In-place boolean operations on views; the result is stored in the cells of
+// the view a.
+template <typename Discretizer, typename T>
+bool UnionVoxels(
+    VoxelGridView<Discretizer> a,
+    const VoxelGridView<Discretizer, T>& b);
+
+template <typename Discretizer, typename T>
+bool IntersectVoxels(
+    VoxelGridView<Discretizer> a,
+    const VoxelGridView<Discretizer, T>& b);
+
+template <typename Discretizer, typename T>
+bool SubtractVoxels(
+    VoxelGridView<Discretizer> a,
+    const VoxelGridView<Discretizer, T>& b);
+
+template <typename Discretizer, typename T>
+bool XorVoxels(
+    VoxelGridView<Discretizer> a,
+    const VoxelGridView<Discretizer, T>& b);
+
+// Out-of-place boolean operations; the result has the extents of a.
+template <typename Discretizer>
+bool UnionVoxels(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b,
+    VoxelGrid<Discretizer>& c);
+
+template <typename Discretizer>
+bool IntersectVoxels(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b,
+    VoxelGrid<Discretizer>& c);
+
+template <typename Discretizer>
+bool SubtractVoxels(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b,
+    VoxelGrid<Discretizer>& c);
+
+template <typename Discretizer>
+bool XorVoxels(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b,
+    VoxelGrid<Discretizer>& c);
+
+template <typename Discretizer>
+bool SameLattice(
+    const VoxelGrid<Discretizer>& a,
+    const VoxelGrid<Discretizer>& b);
+
+} // namespace sbpl
+
+#include "detail/voxel_ops.h"
+
+#endif
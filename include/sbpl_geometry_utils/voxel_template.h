@@ -0,0 +1,118 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef sbpl_geometry_voxel_template_h
+#define sbpl_geometry_voxel_template_h
+
+// standard includes
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/packed_voxel_grid.h>
+#include <sbpl_geometry_utils/voxel_grid.h>
+
+namespace sbpl {
+
+/// \brief A precomputed set of voxels, stored as packed z-rows, for fast
+///     overlap queries against a packed environment grid at integer offsets
+///
+/// Template cells are addressed relative to the template's minimum corner. An
+/// offset (ox, oy, oz) places template cell (i, j, k) on the environment cell
+/// with memory coordinates (ox + i, oy + j, oz + k). Template cells that fall
+/// outside the environment never collide.
+class VoxelTemplate
+{
+public:
+
+    VoxelTemplate();
+
+    VoxelTemplate(const std::vector<Eigen::Vector3d>& voxels, double res);
+
+    void build(const std::vector<Eigen::Vector3d>& voxels, double res);
+
+    bool empty() const { return m_rows.empty(); }
+
+    int sizeX() const { return m_size_x; }
+    int sizeY() const { return m_size_y; }
+    int sizeZ() const { return m_size_z; }
+
+    /// \brief The center of template cell (0, 0, 0)
+    const Eigen::Vector3d& origin() const { return m_origin; }
+
+    int voxelCount() const { return m_voxel_count; }
+
+    bool collides(const PackedVoxelGrid& env, const MemoryCoord& offset) const;
+
+    int overlapCount(const PackedVoxelGrid& env, const MemoryCoord& offset) const;
+
+    void collides(
+        const PackedVoxelGrid& env,
+        const std::vector<MemoryCoord>& offsets,
+        std::vector<bool>& collisions) const;
+
+    int firstCollisionFree(
+        const PackedVoxelGrid& env,
+        const std::vector<MemoryCoord>& offsets) const;
+
+private:
+
+    typedef PackedVoxelGrid::word_type word_type;
+
+    // a run of template bits along z starting at cell (x, y, z)
+    struct Row
+    {
+        int x;
+        int y;
+        int z;
+        int words;
+        int first_word;
+    };
+
+    int m_size_x;
+    int m_size_y;
+    int m_size_z;
+    int m_voxel_count;
+    Eigen::Vector3d m_origin;
+
+    std::vector<Row> m_rows;
+    std::vector<word_type> m_bits;
+
+    template <typename Visitor>
+    bool visitOverlaps(
+        const PackedVoxelGrid& env,
+        const MemoryCoord& offset,
+        Visitor visit) const;
+};
+
+} // namespace sbpl
+
+#endif
@@ -39,17 +39,29 @@
 // project includes
 #include <sbpl_geometry_utils/triangle.h>
 #include <sbpl_geometry_utils/voxel_grid.h>
+#include <sbpl_geometry_utils/voxel_grid_view.h>
+#include <sbpl_geometry_utils/voxel_key.h>
 #include <sbpl_geometry_utils/utils.h>
 
 namespace sbpl {
 
+/// Thickness of the voxelized surface of a triangle, following the
+/// separability criteria of Huang et al.
+enum class Separability
+{
+    Six,            ///< thinnest surface without 6-connected tunnels
+    TwentySix,      ///< surface without 26-connected tunnels
+    Conservative    ///< exactly the cells that the triangle overlaps
+};
+
 void VoxelizeBox(
     double length,
     double width,
     double height,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeBox(
     double length,
@@ -58,7 +70,8 @@ void VoxelizeBox(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeBox(
     double length,
@@ -67,7 +80,8 @@ void VoxelizeBox(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeBox(
     double length,
@@ -77,27 +91,31 @@ void VoxelizeBox(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeSphere(
     double radius,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeSphere(
     double radius,
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeSphere(
     double radius,
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeSphere(
     double radius,
@@ -105,14 +123,16 @@ void VoxelizeSphere(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeCylinder(
     double radius,
     double height,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeCylinder(
     double radius,
@@ -120,7 +140,8 @@ void VoxelizeCylinder(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeCylinder(
     double radius,
@@ -128,7 +149,8 @@ void VoxelizeCylinder(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeCylinder(
     double radius,
@@ -137,14 +159,16 @@ void VoxelizeCylinder(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeCone(
     double radius,
     double height,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeCone(
     double radius,
@@ -152,7 +176,8 @@ void VoxelizeCone(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeCone(
     double radius,
@@ -160,7 +185,8 @@ void VoxelizeCone(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeCone(
     double radius,
@@ -169,14 +195,16 @@ void VoxelizeCone(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeMesh(
     const std::vector<Eigen::Vector3d>& vertices,
     const std::vector<int>& indices,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeMesh(
     const std::vector<Eigen::Vector3d>& vertices,
@@ -184,7 +212,8 @@ void VoxelizeMesh(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeMesh(
     const std::vector<Eigen::Vector3d>& vertices,
@@ -192,7 +221,8 @@ void VoxelizeMesh(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeMesh(
     const std::vector<Eigen::Vector3d>& vertices,
@@ -201,7 +231,69 @@ void VoxelizeMesh(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+bool VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    std::vector<VoxelKey>& keys,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+bool VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    std::vector<VoxelKey>& keys,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+void VoxelizeMeshInRegion(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+void VoxelizeMeshInRegion(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+void VoxelizeMeshInRegion(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+void VoxelizeMeshInRegion(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizePlane(
     double a, double b, double c, double d,
@@ -225,7 +317,16 @@ void VoxelizeSphereList(
     std::vector<Eigen::Vector3d>& voxels,
     double& volume,
     bool unique,
-    bool fill = false);
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+bool VoxelizeSphereList(
+    const std::vector<double>& radii,
+    const std::vector<Eigen::Affine3d>& poses,
+    double res,
+    std::vector<VoxelKey>& keys,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
 
 void VoxelizeSphereListQAD(
     const std::vector<double>& radii,
@@ -236,6 +337,173 @@ void VoxelizeSphereListQAD(
     bool unique,
     bool fill = false);
 
+size_t VoxelizeBoxCount(
+    double length,
+    double width,
+    double height,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeBoxCount(
+    double length,
+    double width,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeBoxCount(
+    double length,
+    double width,
+    double height,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeBoxCount(
+    double length,
+    double width,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeSphereCount(
+    double radius,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeSphereCount(
+    double radius,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeSphereCount(
+    double radius,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeSphereCount(
+    double radius,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeCylinderCount(
+    double radius,
+    double height,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeCylinderCount(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeCylinderCount(
+    double radius,
+    double height,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeCylinderCount(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeConeCount(
+    double radius,
+    double height,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeConeCount(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeConeCount(
+    double radius,
+    double height,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeConeCount(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeMeshCount(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeMeshCount(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeMeshCount(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeMeshCount(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+size_t VoxelizeSphereListCount(
+    const std::vector<double>& radii,
+    const std::vector<Eigen::Affine3d>& poses,
+    double res,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
 bool ComputeAxisAlignedBoundingBox(
     const std::vector<Eigen::Vector3d>& vertices,
     Eigen::Vector3d& min,
@@ -247,12 +515,127 @@ double Distance(
     double radius_sqrd,
     const Eigen::Vector3d& x);
 
-template <typename Discretizer>
+template <typename Grid>
+void VoxelizeTriangle(
+    const Eigen::Vector3d& a,
+    const Eigen::Vector3d& b,
+    const Eigen::Vector3d& c,
+    Grid& vg,
+    Separability sep = Separability::TwentySix);
+
+template <typename Grid>
 void VoxelizeTriangle(
     const Eigen::Vector3d& a,
     const Eigen::Vector3d& b,
     const Eigen::Vector3d& c,
-    VoxelGrid<Discretizer>& vg);
+    const GridCoord& roi_min,
+    const GridCoord& roi_max,
+    Grid& vg,
+    Separability sep = Separability::TwentySix);
+
+template <typename Discretizer>
+void VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    VoxelGrid<Discretizer>& vg,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+template <typename Discretizer, typename T, typename WritePolicy>
+void VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    VoxelGrid<Discretizer, T>& vg,
+    const WritePolicy& write,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+template <typename Discretizer>
+void VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    VoxelGridView<Discretizer> view,
+    bool fill = false,
+    Separability sep = Separability::TwentySix);
+
+template <typename TriangleReader, typename Grid>
+size_t VoxelizeStream(
+    TriangleReader& reader,
+    Grid& vg,
+    size_t chunk_size = 4096,
+    Separability sep = Separability::TwentySix);
+
+template <typename Discretizer>
+void VoxelizeMeshDistance(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    int band,
+    VoxelGrid<Discretizer>& vg,
+    VoxelGrid<Discretizer, float>& distances);
+
+template <typename Discretizer, typename T>
+void VoxelizeBoxCoverage(
+    double length,
+    double width,
+    double height,
+    const Eigen::Affine3d& pose,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples = 4);
+
+template <typename Discretizer, typename T>
+void VoxelizeSphereCoverage(
+    double radius,
+    const Eigen::Affine3d& pose,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples = 4);
+
+template <typename Discretizer, typename T>
+void VoxelizeCylinderCoverage(
+    double radius,
+    double length,
+    const Eigen::Affine3d& pose,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples = 4);
+
+template <typename Discretizer, typename T>
+void VoxelizeConeCoverage(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples = 4);
+
+template <typename Discretizer, typename T>
+void VoxelizeMeshCoverage(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    VoxelGrid<Discretizer, T>& vg,
+    int samples = 4);
+
+template <typename Discretizer>
+void ScanFill(VoxelGrid<Discretizer>& vg);
+
+template <typename Discretizer>
+void ScanFill(VoxelGridView<Discretizer> view);
+
+template <typename Discretizer, typename T>
+size_t CountVoxels(const VoxelGrid<Discretizer, T>& vg);
+
+template <typename Discretizer>
+size_t CountVoxels(const VoxelGrid<Discretizer>& vg);
+
+template <typename Discretizer, typename T>
+size_t CountVoxels(const VoxelGridView<Discretizer, T>& view);
+
+template <typename Discretizer>
+void ExtractVoxels(
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<Eigen::Vector3d>& voxels);
+
+template <typename Discretizer>
+bool ExtractVoxelKeys(
+    const VoxelGrid<Discretizer>& vg,
+    std::vector<VoxelKey>& keys);
 
 } // namespace sbpl
 
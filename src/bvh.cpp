@@ -0,0 +1,623 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <sbpl_geometry_utils/bvh.h>
+
+// standard includes
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+// project includes
+#include <sbpl_geometry_utils/intersect.h>
+
+namespace sbpl {
+
+// number of bins used to evaluate the surface area heuristic along each axis
+static const int BVH_BIN_COUNT = 16;
+
+// subtrees with at least this many triangles are built in parallel tasks
+static const int BVH_PARALLEL_BUILD_THRESHOLD = 4096;
+
+struct BVHBuildContext
+{
+    std::vector<Eigen::Vector3d> mins;
+    std::vector<Eigen::Vector3d> maxs;
+    std::vector<Eigen::Vector3d> centroids;
+    std::vector<int> order;
+    int max_leaf_size;
+};
+
+//////////////////////////////////
+// Static Function Declarations //
+//////////////////////////////////
+
+static void BuildNode(
+    BVHBuildContext* ctx,
+    int begin,
+    int end,
+    std::vector<TriangleBVH::Node>& nodes);
+
+static double SurfaceArea(const Eigen::Vector3d& min, const Eigen::Vector3d& max);
+
+static bool Overlaps(
+    const Eigen::Vector3d& amin, const Eigen::Vector3d& amax,
+    const Eigen::Vector3d& bmin, const Eigen::Vector3d& bmax);
+
+static double SquaredDistance(
+    const Eigen::Vector3d& p,
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max);
+
+static bool IntersectsRay(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& inv_direction,
+    double max_t,
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max);
+
+static bool IntersectRayTriangle(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& direction,
+    const Triangle& tr,
+    double& t);
+
+static void TriangleBounds(
+    const Triangle& tr,
+    Eigen::Vector3d& min,
+    Eigen::Vector3d& max);
+
+/////////////////////////////////
+// Static Function Definitions //
+/////////////////////////////////
+
+/// \brief Append the depth-first ordered nodes of the subtree over the
+///     triangles in order[begin, end) to nodes
+///
+/// Skip indices are relative to the start of the subtree. Subtrees large enough
+/// to be worth it are built in separate tasks and spliced in afterwards.
+void BuildNode(
+    BVHBuildContext* ctx,
+    int begin,
+    int end,
+    std::vector<TriangleBVH::Node>& nodes)
+{
+    const int index = (int)nodes.size();
+    const int count = end - begin;
+
+    TriangleBVH::Node node;
+    node.min = ctx->mins[ctx->order[begin]];
+    node.max = ctx->maxs[ctx->order[begin]];
+    Eigen::Vector3d cmin = ctx->centroids[ctx->order[begin]];
+    Eigen::Vector3d cmax = cmin;
+    for (int i = begin + 1; i < end; ++i) {
+        const int t = ctx->order[i];
+        node.min = node.min.cwiseMin(ctx->mins[t]);
+        node.max = node.max.cwiseMax(ctx->maxs[t]);
+        cmin = cmin.cwiseMin(ctx->centroids[t]);
+        cmax = cmax.cwiseMax(ctx->centroids[t]);
+    }
+    node.first = begin;
+    node.count = 0;
+    node.skip = index + 1;
+    nodes.push_back(node);
+
+    if (count <= ctx->max_leaf_size) {
+        nodes[index].count = count;
+        return;
+    }
+
+    // find the cheapest split among the bin boundaries of all three axes
+    int best_axis = -1;
+    int best_split = 0;
+    double best_cost = std::numeric_limits<double>::infinity();
+    for (int axis = 0; axis < 3; ++axis) {
+        const double extent = cmax[axis] - cmin[axis];
+        if (extent <= 0.0) {
+            continue;
+        }
+
+        int bin_counts[BVH_BIN_COUNT] = { 0 };
+        Eigen::Vector3d bin_mins[BVH_BIN_COUNT];
+        Eigen::Vector3d bin_maxs[BVH_BIN_COUNT];
+        const double scale = BVH_BIN_COUNT / extent;
+        for (int i = begin; i < end; ++i) {
+            const int t = ctx->order[i];
+            int b = (int)((ctx->centroids[t][axis] - cmin[axis]) * scale);
+            b = std::min(b, BVH_BIN_COUNT - 1);
+            if (bin_counts[b]++ == 0) {
+                bin_mins[b] = ctx->mins[t];
+                bin_maxs[b] = ctx->maxs[t];
+            }
+            else {
+                bin_mins[b] = bin_mins[b].cwiseMin(ctx->mins[t]);
+                bin_maxs[b] = bin_maxs[b].cwiseMax(ctx->maxs[t]);
+            }
+        }
+
+        // sweep from the right to accumulate the cost of the right halves
+        double right_costs[BVH_BIN_COUNT];
+        int right_count = 0;
+        Eigen::Vector3d rmin, rmax;
+        for (int b = BVH_BIN_COUNT - 1; b > 0; --b) {
+            if (bin_counts[b] > 0) {
+                if (right_count == 0) {
+                    rmin = bin_mins[b];
+                    rmax = bin_maxs[b];
+                }
+                else {
+                    rmin = rmin.cwiseMin(bin_mins[b]);
+                    rmax = rmax.cwiseMax(bin_maxs[b]);
+                }
+                right_count += bin_counts[b];
+            }
+            right_costs[b] =
+                    right_count > 0 ? right_count * SurfaceArea(rmin, rmax) : 0.0;
+        }
+
+        // sweep from the left and evaluate each split
+        int left_count = 0;
+        Eigen::Vector3d lmin, lmax;
+        for (int b = 0; b < BVH_BIN_COUNT - 1; ++b) {
+            if (bin_counts[b] > 0) {
+                if (left_count == 0) {
+                    lmin = bin_mins[b];
+                    lmax = bin_maxs[b];
+                }
+                else {
+                    lmin = lmin.cwiseMin(bin_mins[b]);
+                    lmax = lmax.cwiseMax(bin_maxs[b]);
+                }
+                left_count += bin_counts[b];
+            }
+            if (left_count == 0 || left_count == count) {
+                continue;
+            }
+            const double cost =
+                    left_count * SurfaceArea(lmin, lmax) + right_costs[b + 1];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = b + 1;
+            }
+        }
+    }
+
+    if (best_axis == -1) {
+        // all centroids coincide; no split separates the triangles
+        nodes[index].count = count;
+        return;
+    }
+
+    const double split_cmin = cmin[best_axis];
+    const double split_scale = BVH_BIN_COUNT / (cmax[best_axis] - cmin[best_axis]);
+    int* mid_ptr = std::partition(
+            &ctx->order[begin], &ctx->order[0] + end,
+            [&](int t)
+            {
+                int b = (int)((ctx->centroids[t][best_axis] - split_cmin) * split_scale);
+                return std::min(b, BVH_BIN_COUNT - 1) < best_split;
+            });
+    int mid = (int)(mid_ptr - &ctx->order[0]);
+    if (mid == begin || mid == end) {
+        mid = begin + count / 2;
+        std::nth_element(
+                &ctx->order[begin], &ctx->order[mid], &ctx->order[0] + end,
+                [&](int a, int b)
+                {
+                    return ctx->centroids[a][best_axis] < ctx->centroids[b][best_axis];
+                });
+    }
+
+    if (count >= BVH_PARALLEL_BUILD_THRESHOLD) {
+        std::vector<TriangleBVH::Node> right_nodes;
+#ifdef _OPENMP
+        #pragma omp task shared(right_nodes)
+#endif
+        BuildNode(ctx, mid, end, right_nodes);
+        BuildNode(ctx, begin, mid, nodes);
+#ifdef _OPENMP
+        #pragma omp taskwait
+#endif
+        const int offset = (int)nodes.size();
+        for (TriangleBVH::Node& n : right_nodes) {
+            n.skip += offset;
+            nodes.push_back(n);
+        }
+    }
+    else {
+        BuildNode(ctx, begin, mid, nodes);
+        BuildNode(ctx, mid, end, nodes);
+    }
+
+    nodes[index].skip = (int)nodes.size();
+}
+
+double SurfaceArea(const Eigen::Vector3d& min, const Eigen::Vector3d& max)
+{
+    const Eigen::Vector3d d = max - min;
+    return 2.0 * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+}
+
+bool Overlaps(
+    const Eigen::Vector3d& amin, const Eigen::Vector3d& amax,
+    const Eigen::Vector3d& bmin, const Eigen::Vector3d& bmax)
+{
+    return amin.x() <= bmax.x() && bmin.x() <= amax.x() &&
+            amin.y() <= bmax.y() && bmin.y() <= amax.y() &&
+            amin.z() <= bmax.z() && bmin.z() <= amax.z();
+}
+
+double SquaredDistance(
+    const Eigen::Vector3d& p,
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max)
+{
+    const Eigen::Vector3d d =
+            (min - p).cwiseMax(Eigen::Vector3d::Zero()).cwiseMax(p - max);
+    return d.squaredNorm();
+}
+
+/// \brief Slab test of a ray against an axis-aligned bounding box
+bool IntersectsRay(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& inv_direction,
+    double max_t,
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max)
+{
+    double tmin = 0.0;
+    double tmax = max_t;
+    for (int i = 0; i < 3; ++i) {
+        double t0 = (min[i] - origin[i]) * inv_direction[i];
+        double t1 = (max[i] - origin[i]) * inv_direction[i];
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        // written so that NaNs from 0 * inf leave the interval unchanged
+        tmin = t0 > tmin ? t0 : tmin;
+        tmax = t1 < tmax ? t1 : tmax;
+        if (tmin > tmax) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \brief Ray-triangle intersection
+///
+/// Based on the algorithm described in:
+///
+/// 'Moller and Trumbore, "Fast, Minimum Storage Ray/Triangle Intersection,"
+/// Journal of Graphics Tools, 2(1), 1997, pp. 21-28'
+bool IntersectRayTriangle(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& direction,
+    const Triangle& tr,
+    double& t)
+{
+    const Eigen::Vector3d e1 = tr.b - tr.a;
+    const Eigen::Vector3d e2 = tr.c - tr.a;
+    const Eigen::Vector3d p = direction.cross(e2);
+    const double det = e1.dot(p);
+    if (det == 0.0) {
+        return false;
+    }
+    const double inv_det = 1.0 / det;
+    const Eigen::Vector3d s = origin - tr.a;
+    const double u = s.dot(p) * inv_det;
+    if (u < 0.0 || u > 1.0) {
+        return false;
+    }
+    const Eigen::Vector3d q = s.cross(e1);
+    const double v = direction.dot(q) * inv_det;
+    if (v < 0.0 || u + v > 1.0) {
+        return false;
+    }
+    t = e2.dot(q) * inv_det;
+    return t >= 0.0;
+}
+
+void TriangleBounds(
+    const Triangle& tr,
+    Eigen::Vector3d& min,
+    Eigen::Vector3d& max)
+{
+    min = tr.a.cwiseMin(tr.b).cwiseMin(tr.c);
+    max = tr.a.cwiseMax(tr.b).cwiseMax(tr.c);
+}
+
+////////////////////////////////
+// Class Function Definitions //
+////////////////////////////////
+
+TriangleBVH::TriangleBVH() :
+    m_nodes(),
+    m_triangles(),
+    m_triangle_ids()
+{
+}
+
+TriangleBVH::TriangleBVH(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    int max_leaf_size)
+{
+    build(vertices, indices, max_leaf_size);
+}
+
+/// \brief Build the hierarchy over an indexed triangle mesh
+///
+/// Any previous hierarchy is discarded.
+void TriangleBVH::build(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    int max_leaf_size)
+{
+    m_nodes.clear();
+    m_triangles.clear();
+    m_triangle_ids.clear();
+
+    const int triangle_count = (int)indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    BVHBuildContext ctx;
+    ctx.mins.resize(triangle_count);
+    ctx.maxs.resize(triangle_count);
+    ctx.centroids.resize(triangle_count);
+    ctx.order.resize(triangle_count);
+    ctx.max_leaf_size = std::max(max_leaf_size, 1);
+
+    std::vector<Triangle> triangles(triangle_count);
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = 0; i < triangle_count; ++i) {
+        triangles[i] = Triangle(
+                vertices[indices[3 * i + 0]],
+                vertices[indices[3 * i + 1]],
+                vertices[indices[3 * i + 2]]);
+        TriangleBounds(triangles[i], ctx.mins[i], ctx.maxs[i]);
+        ctx.centroids[i] = (triangles[i].a + triangles[i].b + triangles[i].c) / 3.0;
+        ctx.order[i] = i;
+    }
+
+    m_nodes.reserve(2 * triangle_count / ctx.max_leaf_size + 1);
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+#ifdef _OPENMP
+        #pragma omp single
+#endif
+        BuildNode(&ctx, 0, triangle_count, m_nodes);
+    }
+
+    m_triangles.resize(triangle_count);
+    m_triangle_ids.resize(triangle_count);
+    for (int i = 0; i < triangle_count; ++i) {
+        m_triangles[i] = triangles[ctx.order[i]];
+        m_triangle_ids[i] = ctx.order[i];
+    }
+}
+
+/// \brief Find the closest intersection of a ray with the mesh
+///
+/// The ray is parameterized as origin + t * direction for t in [0, max_t].
+///
+/// \return Whether the ray hits a triangle; t and triangle are only modified
+///     if it does
+bool TriangleBVH::intersectRay(
+    const Eigen::Vector3d& origin,
+    const Eigen::Vector3d& direction,
+    double max_t,
+    double& t,
+    int& triangle) const
+{
+    const Eigen::Vector3d inv_direction = direction.cwiseInverse();
+
+    double best_t = max_t;
+    int best_triangle = -1;
+    int i = 0;
+    while (i < (int)m_nodes.size()) {
+        const Node& node = m_nodes[i];
+        if (!IntersectsRay(origin, inv_direction, best_t, node.min, node.max)) {
+            i = node.skip;
+            continue;
+        }
+        for (int j = node.first; j < node.first + node.count; ++j) {
+            double tt;
+            if (IntersectRayTriangle(origin, direction, m_triangles[j], tt) &&
+                tt <= best_t)
+            {
+                best_t = tt;
+                best_triangle = j;
+            }
+        }
+        ++i;
+    }
+
+    if (best_triangle == -1) {
+        return false;
+    }
+
+    t = best_t;
+    triangle = m_triangle_ids[best_triangle];
+    return true;
+}
+
+/// \brief Find all triangles whose bounding boxes overlap a given box
+///
+/// Triangle indices are appended to the output vector.
+void TriangleBVH::overlapAABB(
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max,
+    std::vector<int>& triangles) const
+{
+    visitAABB(min, max, [&](int j)
+    {
+        triangles.push_back(m_triangle_ids[j]);
+        return false;
+    });
+}
+
+/// \brief Find the point on the mesh closest to a given point
+///
+/// \return false if the hierarchy is empty
+bool TriangleBVH::closestPoint(
+    const Eigen::Vector3d& p,
+    Eigen::Vector3d& closest,
+    int& triangle) const
+{
+    double best_d2 = std::numeric_limits<double>::infinity();
+    int best_triangle = -1;
+    int i = 0;
+    while (i < (int)m_nodes.size()) {
+        const Node& node = m_nodes[i];
+        if (SquaredDistance(p, node.min, node.max) > best_d2) {
+            i = node.skip;
+            continue;
+        }
+        for (int j = node.first; j < node.first + node.count; ++j) {
+            const Eigen::Vector3d q = ClosestPointOnTriangle(p, m_triangles[j]);
+            const double d2 = (q - p).squaredNorm();
+            if (d2 < best_d2) {
+                best_d2 = d2;
+                best_triangle = j;
+                closest = q;
+            }
+        }
+        ++i;
+    }
+
+    if (best_triangle == -1) {
+        return false;
+    }
+
+    triangle = m_triangle_ids[best_triangle];
+    return true;
+}
+
+/// \brief Test whether any triangle of this mesh intersects any triangle of
+///     another mesh
+bool TriangleBVH::intersects(const TriangleBVH& other) const
+{
+    return findIntersections(other, [](int, int) { return true; });
+}
+
+/// \brief Find all pairs of intersecting triangles between this mesh and
+///     another mesh
+///
+/// Pairs of (this triangle, other triangle) indices are appended to the output
+/// vector.
+void TriangleBVH::intersectingTriangles(
+    const TriangleBVH& other,
+    std::vector<std::pair<int, int>>& pairs) const
+{
+    findIntersections(other, [&](int i, int j)
+    {
+        pairs.push_back(std::make_pair(m_triangle_ids[i], other.m_triangle_ids[j]));
+        return false;
+    });
+}
+
+/// \brief Call visit(j) for each leaf-ordered triangle j whose bounding box
+///     overlaps the given box, until visit returns true
+template <typename Visitor>
+void TriangleBVH::visitAABB(
+    const Eigen::Vector3d& min,
+    const Eigen::Vector3d& max,
+    Visitor visit) const
+{
+    int i = 0;
+    while (i < (int)m_nodes.size()) {
+        const Node& node = m_nodes[i];
+        if (!Overlaps(min, max, node.min, node.max)) {
+            i = node.skip;
+            continue;
+        }
+        for (int j = node.first; j < node.first + node.count; ++j) {
+            Eigen::Vector3d tmin, tmax;
+            TriangleBounds(m_triangles[j], tmin, tmax);
+            if (Overlaps(min, max, tmin, tmax) && visit(j)) {
+                return;
+            }
+        }
+        ++i;
+    }
+}
+
+/// \brief Call visit(i, j) for each pair of intersecting leaf-ordered triangles
+///     until visit returns true
+///
+/// Each leaf of this hierarchy is queried against the other hierarchy.
+///
+/// \return Whether visit returned true
+template <typename Visitor>
+bool TriangleBVH::findIntersections(
+    const TriangleBVH& other,
+    Visitor visit) const
+{
+    if (m_nodes.empty() || other.m_nodes.empty()) {
+        return false;
+    }
+
+    const Node& other_root = other.m_nodes.front();
+    int i = 0;
+    while (i < (int)m_nodes.size()) {
+        const Node& node = m_nodes[i];
+        if (!Overlaps(node.min, node.max, other_root.min, other_root.max)) {
+            i = node.skip;
+            continue;
+        }
+        for (int j = node.first; j < node.first + node.count; ++j) {
+            const Triangle& tr = m_triangles[j];
+            Eigen::Vector3d tmin, tmax;
+            TriangleBounds(tr, tmin, tmax);
+            bool done = false;
+            other.visitAABB(tmin, tmax, [&](int k)
+            {
+                if (Intersects(tr, other.m_triangles[k])) {
+                    done = visit(j, k);
+                }
+                return done;
+            });
+            if (done) {
+                return true;
+            }
+        }
+        ++i;
+    }
+
+    return false;
+}
+
+} // namespace sbpl
@@ -0,0 +1,256 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <sbpl_geometry_utils/connected_components.h>
+
+// standard includes
+#include <algorithm>
+#include <iostream>
+
+namespace sbpl {
+
+// number of x-planes labeled independently before slabs are merged
+static const int CCL_SLAB_THICKNESS = 16;
+
+struct NeighborOffset
+{
+    int dx;
+    int dy;
+    int dz;
+};
+
+//////////////////////////////////
+// Static Function Declarations //
+//////////////////////////////////
+
+static void BackwardNeighborOffsets(
+    int connectivity,
+    std::vector<NeighborOffset>& offsets);
+
+static int FindRoot(int* parent, int i);
+
+static void Union(int* parent, int i, int j);
+
+/////////////////////////////////
+// Static Function Definitions //
+/////////////////////////////////
+
+// Gather the neighbor offsets that precede a cell in memory order
+void BackwardNeighborOffsets(
+    int connectivity,
+    std::vector<NeighborOffset>& offsets)
+{
+    const int max_nonzero =
+            connectivity == 6 ? 1 : connectivity == 18 ? 2 : 3;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dz = -1; dz <= 1; ++dz) {
+                const bool backward =
+                        dx < 0 || (dx == 0 && (dy < 0 || (dy == 0 && dz < 0)));
+                const int nonzero = (dx != 0) + (dy != 0) + (dz != 0);
+                if (backward && nonzero <= max_nonzero) {
+                    NeighborOffset off = { dx, dy, dz };
+                    offsets.push_back(off);
+                }
+            }
+        }
+    }
+}
+
+int FindRoot(int* parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// Link the larger root to the smaller so that every root is the first cell of
+// its component in memory order and parent[i] <= i always holds
+void Union(int* parent, int i, int j)
+{
+    i = FindRoot(parent, i);
+    j = FindRoot(parent, j);
+    if (i < j) {
+        parent[j] = i;
+    }
+    else if (j < i) {
+        parent[i] = j;
+    }
+}
+
+/////////////////////////////////
+// Public Function Definitions //
+/////////////////////////////////
+
+/// \brief Label the connected components of the nonzero cells of a dense grid
+///
+/// Cells are stored in memory order (z fastest). The first pass builds a
+/// union-find forest over cell indices independently for slabs of x-planes in
+/// parallel; the forests are then joined across slab boundaries and a second
+/// pass assigns labels 1 through the number of components, in order of each
+/// component's first cell. Empty cells are labeled 0. One component, with its
+/// bounding box in memory coordinates, is appended per label.
+///
+/// \param connectivity 6 (faces), 18 (faces and edges), or 26 (faces, edges,
+///     and corners)
+bool LabelConnectedComponents(
+    const unsigned char* cells,
+    int size_x,
+    int size_y,
+    int size_z,
+    int connectivity,
+    int* labels,
+    std::vector<VoxelComponent>& components)
+{
+    if (connectivity != 6 && connectivity != 18 && connectivity != 26) {
+        std::cerr << "Connectivity must be 6, 18, or 26" << std::endl;
+        return false;
+    }
+
+    const int sx = size_x;
+    const int sy = size_y;
+    const int sz = size_z;
+    const size_t n = (size_t)sx * sy * sz;
+    if (n == 0) {
+        return true;
+    }
+
+    std::vector<NeighborOffset> offsets;
+    BackwardNeighborOffsets(connectivity, offsets);
+
+    std::vector<int> parent_storage(n);
+    int* parent = parent_storage.data();
+
+    // first pass: label each slab independently
+    const int slab_count = (sx + CCL_SLAB_THICKNESS - 1) / CCL_SLAB_THICKNESS;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int s = 0; s < slab_count; ++s) {
+        const int xbegin = s * CCL_SLAB_THICKNESS;
+        const int xend = std::min(sx, xbegin + CCL_SLAB_THICKNESS);
+        for (int x = xbegin; x < xend; ++x) {
+            for (int y = 0; y < sy; ++y) {
+                for (int z = 0; z < sz; ++z) {
+                    const int i = (x * sy + y) * sz + z;
+                    if (!cells[i]) {
+                        parent[i] = -1;
+                        continue;
+                    }
+                    parent[i] = i;
+                    for (const NeighborOffset& off : offsets) {
+                        const int nx = x + off.dx;
+                        const int ny = y + off.dy;
+                        const int nz = z + off.dz;
+                        if (nx < xbegin ||
+                            ny < 0 || ny >= sy ||
+                            nz < 0 || nz >= sz)
+                        {
+                            continue;
+                        }
+                        const int j = (nx * sy + ny) * sz + nz;
+                        if (cells[j]) {
+                            Union(parent, i, j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // merge step: join components across slab boundaries
+    for (int s = 1; s < slab_count; ++s) {
+        const int x = s * CCL_SLAB_THICKNESS;
+        for (int y = 0; y < sy; ++y) {
+            for (int z = 0; z < sz; ++z) {
+                const int i = (x * sy + y) * sz + z;
+                if (!cells[i]) {
+                    continue;
+                }
+                for (const NeighborOffset& off : offsets) {
+                    if (off.dx != -1) {
+                        continue;
+                    }
+                    const int ny = y + off.dy;
+                    const int nz = z + off.dz;
+                    if (ny < 0 || ny >= sy || nz < 0 || nz >= sz) {
+                        continue;
+                    }
+                    const int j = ((x - 1) * sy + ny) * sz + nz;
+                    if (cells[j]) {
+                        Union(parent, i, j);
+                    }
+                }
+            }
+        }
+    }
+
+    // second pass: since parent[i] <= i, the label of a cell's parent is final
+    // by the time the cell is visited
+    const size_t first = components.size();
+    int label_count = 0;
+    int i = 0;
+    for (int x = 0; x < sx; ++x) {
+        for (int y = 0; y < sy; ++y) {
+            for (int z = 0; z < sz; ++z, ++i) {
+                if (parent[i] < 0) {
+                    labels[i] = 0;
+                    continue;
+                }
+
+                if (parent[i] == i) {
+                    labels[i] = ++label_count;
+                    VoxelComponent c;
+                    c.label = label_count;
+                    c.min = GridCoord(x, y, z);
+                    c.max = GridCoord(x, y, z);
+                    components.push_back(c);
+                }
+                else {
+                    labels[i] = labels[parent[i]];
+                }
+
+                VoxelComponent& c = components[first + labels[i] - 1];
+                ++c.count;
+                c.min.x = std::min(c.min.x, x);
+                c.min.y = std::min(c.min.y, y);
+                c.min.z = std::min(c.min.z, z);
+                c.max.x = std::max(c.max.x, x);
+                c.max.y = std::max(c.max.y, y);
+                c.max.z = std::max(c.max.z, z);
+            }
+        }
+    }
+
+    return true;
+}
+
+} // namespace sbpl
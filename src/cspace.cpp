@@ -0,0 +1,320 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <sbpl_geometry_utils/cspace.h>
+
+// standard includes
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+// project includes
+#include <sbpl_geometry_utils/rasterize.h>
+
+namespace sbpl {
+namespace raster {
+
+typedef std::uint64_t word_type;
+
+static const int WORD_BITS = 64;
+
+// a run of footprint cells [dx0, dx1] in template row dy, relative to the
+// footprint center
+struct FootprintRun
+{
+    int dy;
+    int dx0;
+    int dx1;
+};
+
+//////////////////////////////////
+// Static Function Declarations //
+//////////////////////////////////
+
+static bool PointInPolygon(
+    const std::vector<Eigen::Vector2d>& polygon,
+    const Eigen::Vector2d& p);
+
+static void ShiftRowDown(
+    const word_type* src, word_type* dst, int words, int shift);
+
+static void RunOr(
+    const word_type* src, word_type* dst, word_type* tmp, int words, int length);
+
+/////////////////////////////////
+// Static Function Definitions //
+/////////////////////////////////
+
+bool PointInPolygon(
+    const std::vector<Eigen::Vector2d>& polygon,
+    const Eigen::Vector2d& p)
+{
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const Eigen::Vector2d& a = polygon[i];
+        const Eigen::Vector2d& b = polygon[j];
+        if ((a.y() > p.y()) != (b.y() > p.y()) &&
+            p.x() < (b.x() - a.x()) * (p.y() - a.y()) / (b.y() - a.y()) + a.x())
+        {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// dst[x] = src[x + shift], shifting in zeros
+void ShiftRowDown(const word_type* src, word_type* dst, int words, int shift)
+{
+    const int wshift = shift / WORD_BITS;
+    const int bshift = shift % WORD_BITS;
+    for (int i = 0; i < words; ++i) {
+        const int j = i + wshift;
+        word_type w = 0;
+        if (j < words) {
+            w = src[j] >> bshift;
+            if (bshift != 0 && j + 1 < words) {
+                w |= src[j + 1] << (WORD_BITS - bshift);
+            }
+        }
+        dst[i] = w;
+    }
+}
+
+// dst[x] = src[x] | src[x + 1] | ... | src[x + length - 1], computed by
+// doubling the covered interval with each shifted OR
+void RunOr(
+    const word_type* src, word_type* dst, word_type* tmp, int words, int length)
+{
+    std::copy(src, src + words, dst);
+    int covered = 1;
+    while (covered < length) {
+        const int step = std::min(covered, length - covered);
+        ShiftRowDown(dst, tmp, words, step);
+        for (int i = 0; i < words; ++i) {
+            dst[i] |= tmp[i];
+        }
+        covered += step;
+    }
+}
+
+/////////////////////////////////
+// Public Function Definitions //
+/////////////////////////////////
+
+/// @brief Rasterize a polygonal footprint rotated by a heading.
+///
+/// Cells whose centers lie inside the rotated footprint, and cells crossed by
+/// its edges, are marked by the value 1 in a grid of size (2 * radius + 1) x
+/// (2 * radius + 1), indexed as grid[(2 * radius + 1) * y + x], whose center
+/// cell (radius, radius) contains the footprint origin. The footprint
+/// vertices, in meters, must lie within radius - 1 cells of the origin.
+///
+/// @param footprint The vertices of the footprint polygon
+/// @param theta The heading, rotating the +x axis toward the +y axis
+/// @param res The size of each cell
+/// @param radius The half-width of the grid, in cells
+/// @param grid The grid, which is not cleared beforehand
+void RasterizeFootprint(
+    const std::vector<Eigen::Vector2d>& footprint,
+    double theta,
+    double res,
+    int radius,
+    unsigned char* grid)
+{
+    if (footprint.empty()) {
+        return;
+    }
+
+    const int size = 2 * radius + 1;
+    const Eigen::Rotation2Dd rot(theta);
+
+    std::vector<Eigen::Vector2d> polygon(footprint.size());
+    for (size_t i = 0; i < footprint.size(); ++i) {
+        polygon[i] = rot * footprint[i];
+    }
+
+    // mark cells whose centers lie within the footprint
+    if (polygon.size() >= 3) {
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const Eigen::Vector2d p((x - radius) * res, (y - radius) * res);
+                if (PointInPolygon(polygon, p)) {
+                    grid[size * y + x] = 1;
+                }
+            }
+        }
+    }
+
+    // mark cells crossed by the footprint edges
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        const Eigen::Vector2d& a = polygon[i];
+        const Eigen::Vector2d& b = polygon[(i + 1) % polygon.size()];
+        RasterizeLine(
+                radius + (int)floor(a.x() / res + 0.5),
+                radius + (int)floor(a.y() / res + 0.5),
+                radius + (int)floor(b.x() / res + 0.5),
+                radius + (int)floor(b.y() / res + 0.5),
+                grid, size, size);
+    }
+}
+
+FootprintCSpace::FootprintCSpace() :
+    m_width(0),
+    m_height(0),
+    m_heading_count(0),
+    m_words(0),
+    m_maps()
+{
+}
+
+/// @brief Build the configuration-space obstacle maps of a footprint.
+///
+/// Heading i corresponds to the angle 2 * pi * i / heading_count. For each
+/// heading, the footprint template is correlated with the obstacle map one
+/// template row at a time: runs of template cells are applied to packed map
+/// rows as an OR over the run, computed with O(log length) shifted ORs.
+/// Headings are processed in parallel.
+///
+/// @param grid The obstacle map, indexed as grid[width * y + x]
+/// @param width The width of the grid
+/// @param height The height of the grid
+/// @param res The size of each cell
+/// @param footprint The vertices of the footprint polygon, in meters, about
+///     the center of the robot
+/// @param heading_count The number of discrete headings
+bool FootprintCSpace::build(
+    const unsigned char* grid,
+    int width,
+    int height,
+    double res,
+    const std::vector<Eigen::Vector2d>& footprint,
+    int heading_count)
+{
+    if (!grid || width <= 0 || height <= 0 || res <= 0.0 ||
+        footprint.empty() || heading_count <= 0)
+    {
+        std::cerr << "Invalid configuration space parameters" << std::endl;
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_heading_count = heading_count;
+    m_words = (width + WORD_BITS - 1) / WORD_BITS;
+    m_maps.assign((size_t)heading_count * height * m_words, 0);
+
+    // size the footprint templates to contain every heading
+    double max_dist = 0.0;
+    for (const Eigen::Vector2d& v : footprint) {
+        max_dist = std::max(max_dist, v.norm());
+    }
+    const int radius = (int)ceil(max_dist / res) + 1;
+    const int tsize = 2 * radius + 1;
+
+    // pack the obstacle map, padded by radius cells of obstacles on all sides
+    const int pwidth = width + 2 * radius;
+    const int pheight = height + 2 * radius;
+    const int pwords = (pwidth + WORD_BITS - 1) / WORD_BITS;
+    std::vector<word_type> padded((size_t)pheight * pwords, 0);
+    for (int py = 0; py < pheight; ++py) {
+        word_type* row = &padded[(size_t)py * pwords];
+        const int y = py - radius;
+        for (int px = 0; px < pwidth; ++px) {
+            const int x = px - radius;
+            const bool occupied = x < 0 || x >= width || y < 0 || y >= height ||
+                    grid[width * y + x];
+            if (occupied) {
+                row[px / WORD_BITS] |= word_type(1) << (px % WORD_BITS);
+            }
+        }
+    }
+
+    const word_type last_mask = (width % WORD_BITS) == 0 ?
+            ~word_type(0) : (word_type(1) << (width % WORD_BITS)) - 1;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int h = 0; h < heading_count; ++h) {
+        const double theta = 2.0 * M_PI * h / heading_count;
+
+        std::vector<unsigned char> tmpl((size_t)tsize * tsize, 0);
+        RasterizeFootprint(footprint, theta, res, radius, tmpl.data());
+
+        std::vector<FootprintRun> runs;
+        for (int ty = 0; ty < tsize; ++ty) {
+            int tx = 0;
+            while (tx < tsize) {
+                if (!tmpl[tsize * ty + tx]) {
+                    ++tx;
+                    continue;
+                }
+                FootprintRun run;
+                run.dy = ty - radius;
+                run.dx0 = tx - radius;
+                while (tx < tsize && tmpl[tsize * ty + tx]) {
+                    ++tx;
+                }
+                run.dx1 = tx - 1 - radius;
+                runs.push_back(run);
+            }
+        }
+
+        std::vector<word_type> run_or(pwords);
+        std::vector<word_type> shifted(pwords);
+        std::vector<word_type> tmp(pwords);
+        for (int y = 0; y < height; ++y) {
+            word_type* out = &m_maps[((size_t)h * height + y) * m_words];
+            for (const FootprintRun& run : runs) {
+                const word_type* src =
+                        &padded[(size_t)(y + radius + run.dy) * pwords];
+                RunOr(src, run_or.data(), tmp.data(), pwords, run.dx1 - run.dx0 + 1);
+                ShiftRowDown(run_or.data(), shifted.data(), pwords, radius + run.dx0);
+                for (int i = 0; i < m_words; ++i) {
+                    out[i] |= shifted[i];
+                }
+            }
+            out[m_words - 1] &= last_mask;
+        }
+    }
+
+    return true;
+}
+
+/// @brief Return the index of the discrete heading nearest to an angle
+int FootprintCSpace::headingIndex(double theta) const
+{
+    const double step = 2.0 * M_PI / m_heading_count;
+    const int i = (int)floor(theta / step + 0.5) % m_heading_count;
+    return i < 0 ? i + m_heading_count : i;
+}
+
+} // end namespace raster
+} // end namespace sbpl
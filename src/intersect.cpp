@@ -0,0 +1,509 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <sbpl_geometry_utils/intersect.h>
+
+// standard includes
+#include <math.h>
+#include <algorithm>
+
+namespace sbpl {
+
+// number of triangles run through the batched rejection test at a time
+static const size_t INTERSECT_BLOCK_SIZE = 64;
+
+//////////////////////////////////
+// Static Function Declarations //
+//////////////////////////////////
+
+static bool Intersects(
+    const Triangle& tr1,
+    const Eigen::Vector3d& n1,
+    double d1,
+    const Triangle& tr2,
+    double eps);
+
+static bool IntersectsCoplanar(
+    const Triangle& tr1,
+    const Triangle& tr2,
+    const Eigen::Vector3d& n);
+
+static size_t RejectSeparated(
+    const TriangleArray& triangles,
+    size_t begin,
+    size_t count,
+    const Eigen::Vector3d& n,
+    double d,
+    double e,
+    unsigned char* candidates);
+
+static bool ComputeInterval(
+    const double p[3],
+    const double d[3],
+    double& t0,
+    double& t1);
+
+static double Orient2D(
+    const Eigen::Vector2d& a,
+    const Eigen::Vector2d& b,
+    const Eigen::Vector2d& c);
+
+static bool SegmentsIntersect2D(
+    const Eigen::Vector2d& p1,
+    const Eigen::Vector2d& p2,
+    const Eigen::Vector2d& q1,
+    const Eigen::Vector2d& q2);
+
+static bool PointInTriangle2D(
+    const Eigen::Vector2d& p,
+    const Eigen::Vector2d tr[3]);
+
+/////////////////////////////////
+// Static Function Definitions //
+/////////////////////////////////
+
+/// \brief Triangle-triangle intersection with the plane of the first triangle
+///     already computed
+///
+/// Based on the interval overlap algorithm described in:
+///
+/// 'Moller, "A Fast Triangle-Triangle Intersection Test," Journal of Graphics
+/// Tools, 2(2), 1997, pp. 25-30'
+///
+/// Signed distances within eps of a plane are snapped to zero so that touching
+/// and nearly coplanar configurations are classified consistently.
+bool Intersects(
+    const Triangle& tr1,
+    const Eigen::Vector3d& n1,
+    double d1,
+    const Triangle& tr2,
+    double eps)
+{
+    const Eigen::Vector3d n2 = (tr2.b - tr2.a).cross(tr2.c - tr2.a);
+    const double n2_sqrd = n2.squaredNorm();
+    if (n2_sqrd == 0.0) {
+        return false;
+    }
+
+    // signed distances (scaled by |n2|) of triangle 1 to the plane of triangle 2
+    const double d2 = -n2.dot(tr2.a);
+    const double eps2 = eps * eps * n2_sqrd;
+    double du[3] = {
+        n2.dot(tr1.a) + d2, n2.dot(tr1.b) + d2, n2.dot(tr1.c) + d2
+    };
+    for (int i = 0; i < 3; ++i) {
+        if (du[i] * du[i] <= eps2) {
+            du[i] = 0.0;
+        }
+    }
+    if (du[0] * du[1] > 0.0 && du[0] * du[2] > 0.0) {
+        return false;
+    }
+
+    // signed distances (scaled by |n1|) of triangle 2 to the plane of triangle 1
+    const double eps1 = eps * eps * n1.squaredNorm();
+    double dv[3] = {
+        n1.dot(tr2.a) + d1, n1.dot(tr2.b) + d1, n1.dot(tr2.c) + d1
+    };
+    for (int i = 0; i < 3; ++i) {
+        if (dv[i] * dv[i] <= eps1) {
+            dv[i] = 0.0;
+        }
+    }
+    if (dv[0] * dv[1] > 0.0 && dv[0] * dv[2] > 0.0) {
+        return false;
+    }
+
+    if (du[0] == 0.0 && du[1] == 0.0 && du[2] == 0.0) {
+        return IntersectsCoplanar(tr1, tr2, n1);
+    }
+
+    // project onto the largest component of the intersection line direction
+    const Eigen::Vector3d D = n1.cross(n2);
+    int axis;
+    D.cwiseAbs().maxCoeff(&axis);
+
+    const double p1[3] = { tr1.a[axis], tr1.b[axis], tr1.c[axis] };
+    const double p2[3] = { tr2.a[axis], tr2.b[axis], tr2.c[axis] };
+    double t10, t11, t20, t21;
+    if (!ComputeInterval(p1, du, t10, t11) ||
+        !ComputeInterval(p2, dv, t20, t21))
+    {
+        return IntersectsCoplanar(tr1, tr2, n1);
+    }
+
+    if (t10 > t11) {
+        std::swap(t10, t11);
+    }
+    if (t20 > t21) {
+        std::swap(t20, t21);
+    }
+    return t10 <= t21 && t20 <= t11;
+}
+
+/// \brief Test two coplanar triangles for intersection
+///
+/// Both triangles are projected onto the axis-aligned plane in which the
+/// common normal n has the largest projected area.
+bool IntersectsCoplanar(
+    const Triangle& tr1,
+    const Triangle& tr2,
+    const Eigen::Vector3d& n)
+{
+    int drop;
+    n.cwiseAbs().maxCoeff(&drop);
+    const int i0 = (drop + 1) % 3;
+    const int i1 = (drop + 2) % 3;
+
+    const Eigen::Vector2d p[3] = {
+        Eigen::Vector2d(tr1.a[i0], tr1.a[i1]),
+        Eigen::Vector2d(tr1.b[i0], tr1.b[i1]),
+        Eigen::Vector2d(tr1.c[i0], tr1.c[i1])
+    };
+    const Eigen::Vector2d q[3] = {
+        Eigen::Vector2d(tr2.a[i0], tr2.a[i1]),
+        Eigen::Vector2d(tr2.b[i0], tr2.b[i1]),
+        Eigen::Vector2d(tr2.c[i0], tr2.c[i1])
+    };
+
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (SegmentsIntersect2D(p[i], p[(i + 1) % 3], q[j], q[(j + 1) % 3])) {
+                return true;
+            }
+        }
+    }
+
+    // no edges cross, so either one triangle contains the other or they are
+    // disjoint
+    return PointInTriangle2D(p[0], q) || PointInTriangle2D(q[0], p);
+}
+
+/// \brief Flag the triangles in [begin, begin + count) that do not lie
+///     strictly on one side of the plane n.dot(x) + d = 0
+///
+/// \param e The distance threshold, scaled by |n|, beyond which a vertex is
+///     considered off the plane
+/// \return The number of flagged triangles
+size_t RejectSeparated(
+    const TriangleArray& triangles,
+    size_t begin,
+    size_t count,
+    const Eigen::Vector3d& n,
+    double d,
+    double e,
+    unsigned char* candidates)
+{
+    const double nx = n.x(), ny = n.y(), nz = n.z();
+    const double* ax = &triangles.ax[begin];
+    const double* ay = &triangles.ay[begin];
+    const double* az = &triangles.az[begin];
+    const double* bx = &triangles.bx[begin];
+    const double* by = &triangles.by[begin];
+    const double* bz = &triangles.bz[begin];
+    const double* cx = &triangles.cx[begin];
+    const double* cy = &triangles.cy[begin];
+    const double* cz = &triangles.cz[begin];
+    size_t candidate_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const double da = nx * ax[i] + ny * ay[i] + nz * az[i] + d;
+        const double db = nx * bx[i] + ny * by[i] + nz * bz[i] + d;
+        const double dc = nx * cx[i] + ny * cy[i] + nz * cz[i] + d;
+        const bool above = (da > e) & (db > e) & (dc > e);
+        const bool below = (da < -e) & (db < -e) & (dc < -e);
+        candidates[i] = !(above | below);
+        candidate_count += candidates[i];
+    }
+    return candidate_count;
+}
+
+/// \brief Compute the interval along the plane intersection line covered by a
+///     triangle
+///
+/// \param p The projections of the triangle vertices onto the line
+/// \param d The signed distances of the triangle vertices to the other plane
+/// \return false if all vertices lie on the other plane
+bool ComputeInterval(
+    const double p[3],
+    const double d[3],
+    double& t0,
+    double& t1)
+{
+    // find the vertex alone on its side of the other triangle's plane
+    int k;
+    if (d[0] * d[1] > 0.0) {
+        k = 2;
+    }
+    else if (d[0] * d[2] > 0.0) {
+        k = 1;
+    }
+    else if (d[1] * d[2] > 0.0 || d[0] != 0.0) {
+        k = 0;
+    }
+    else if (d[1] != 0.0) {
+        k = 1;
+    }
+    else if (d[2] != 0.0) {
+        k = 2;
+    }
+    else {
+        return false;
+    }
+    const int i = (k + 1) % 3;
+    const int j = (k + 2) % 3;
+    t0 = p[k] + (p[i] - p[k]) * d[k] / (d[k] - d[i]);
+    t1 = p[k] + (p[j] - p[k]) * d[k] / (d[k] - d[j]);
+    return true;
+}
+
+double Orient2D(
+    const Eigen::Vector2d& a,
+    const Eigen::Vector2d& b,
+    const Eigen::Vector2d& c)
+{
+    return (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+}
+
+/// \brief Test two closed line segments for intersection, including touching
+///     and overlapping collinear segments
+bool SegmentsIntersect2D(
+    const Eigen::Vector2d& p1,
+    const Eigen::Vector2d& p2,
+    const Eigen::Vector2d& q1,
+    const Eigen::Vector2d& q2)
+{
+    const double o1 = Orient2D(p1, p2, q1);
+    const double o2 = Orient2D(p1, p2, q2);
+    if (o1 == 0.0 && o2 == 0.0) {
+        // collinear; compare extents along the dominant direction
+        const int axis = fabs(p2.x() - p1.x()) >= fabs(p2.y() - p1.y()) ? 0 : 1;
+        const double pmin = std::min(p1[axis], p2[axis]);
+        const double pmax = std::max(p1[axis], p2[axis]);
+        const double qmin = std::min(q1[axis], q2[axis]);
+        const double qmax = std::max(q1[axis], q2[axis]);
+        return pmin <= qmax && qmin <= pmax;
+    }
+    if (o1 * o2 > 0.0) {
+        return false;
+    }
+    const double o3 = Orient2D(q1, q2, p1);
+    const double o4 = Orient2D(q1, q2, p2);
+    return o3 * o4 <= 0.0;
+}
+
+/// \brief Test whether a point lies inside or on a triangle of either winding
+bool PointInTriangle2D(const Eigen::Vector2d& p, const Eigen::Vector2d tr[3])
+{
+    const double o1 = Orient2D(tr[0], tr[1], p);
+    const double o2 = Orient2D(tr[1], tr[2], p);
+    const double o3 = Orient2D(tr[2], tr[0], p);
+    return (o1 >= 0.0 && o2 >= 0.0 && o3 >= 0.0) ||
+            (o1 <= 0.0 && o2 <= 0.0 && o3 <= 0.0);
+}
+
+////////////////////////////////
+// Class Function Definitions //
+////////////////////////////////
+
+TriangleArray::TriangleArray(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices)
+{
+    reserve(indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        push_back(Triangle(
+                vertices[indices[i]],
+                vertices[indices[i + 1]],
+                vertices[indices[i + 2]]));
+    }
+}
+
+void TriangleArray::reserve(size_t n)
+{
+    ax.reserve(n); ay.reserve(n); az.reserve(n);
+    bx.reserve(n); by.reserve(n); bz.reserve(n);
+    cx.reserve(n); cy.reserve(n); cz.reserve(n);
+}
+
+void TriangleArray::clear()
+{
+    ax.clear(); ay.clear(); az.clear();
+    bx.clear(); by.clear(); bz.clear();
+    cx.clear(); cy.clear(); cz.clear();
+}
+
+void TriangleArray::push_back(const Triangle& tr)
+{
+    ax.push_back(tr.a.x()); ay.push_back(tr.a.y()); az.push_back(tr.a.z());
+    bx.push_back(tr.b.x()); by.push_back(tr.b.y()); bz.push_back(tr.b.z());
+    cx.push_back(tr.c.x()); cy.push_back(tr.c.y()); cz.push_back(tr.c.z());
+}
+
+/////////////////////////////////
+// Public Function Definitions //
+/////////////////////////////////
+
+/// \brief Test two triangles for intersection
+///
+/// Touching triangles, including coplanar triangles that share only an edge or
+/// a vertex, are considered intersecting. Degenerate triangles never intersect.
+///
+/// \param eps Distance within which a vertex is considered to lie on the plane
+///     of the other triangle
+bool Intersects(const Triangle& tr1, const Triangle& tr2, double eps)
+{
+    const Eigen::Vector3d n1 = (tr1.b - tr1.a).cross(tr1.c - tr1.a);
+    if (n1.squaredNorm() == 0.0) {
+        return false;
+    }
+    return Intersects(tr1, n1, -n1.dot(tr1.a), tr2, eps);
+}
+
+/// \brief Find all triangles in a set that intersect a given triangle
+///
+/// The plane of tr is computed once and the triangles that lie strictly to one
+/// side of it are rejected in blocks before the full test is run on the rest.
+/// Indices of intersecting triangles are appended to the output vector.
+void IntersectingTriangles(
+    const Triangle& tr,
+    const TriangleArray& triangles,
+    std::vector<int>& indices,
+    double eps)
+{
+    const Eigen::Vector3d n = (tr.b - tr.a).cross(tr.c - tr.a);
+    if (n.squaredNorm() == 0.0) {
+        return;
+    }
+    const double d = -n.dot(tr.a);
+    const double e = eps * n.norm();
+
+    unsigned char candidates[INTERSECT_BLOCK_SIZE];
+    for (size_t begin = 0; begin < triangles.size(); begin += INTERSECT_BLOCK_SIZE) {
+        const size_t count =
+                std::min(INTERSECT_BLOCK_SIZE, triangles.size() - begin);
+        if (RejectSeparated(triangles, begin, count, n, d, e, candidates) == 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            if (candidates[i] &&
+                Intersects(tr, n, d, triangles[begin + i], eps))
+            {
+                indices.push_back((int)(begin + i));
+            }
+        }
+    }
+}
+
+/// \brief Compute the point on a triangle closest to a given point
+///
+/// Based on the Voronoi region classification described in:
+///
+/// 'Ericson, "Real-Time Collision Detection," Morgan Kaufmann, 2005, pp.
+/// 136-142'
+Eigen::Vector3d ClosestPointOnTriangle(
+    const Eigen::Vector3d& p,
+    const Triangle& tr)
+{
+    const Eigen::Vector3d ab = tr.b - tr.a;
+    const Eigen::Vector3d ac = tr.c - tr.a;
+    const Eigen::Vector3d ap = p - tr.a;
+    const double d1 = ab.dot(ap);
+    const double d2 = ac.dot(ap);
+    if (d1 <= 0.0 && d2 <= 0.0) {
+        return tr.a;
+    }
+
+    const Eigen::Vector3d bp = p - tr.b;
+    const double d3 = ab.dot(bp);
+    const double d4 = ac.dot(bp);
+    if (d3 >= 0.0 && d4 <= d3) {
+        return tr.b;
+    }
+
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        return tr.a + (d1 / (d1 - d3)) * ab;
+    }
+
+    const Eigen::Vector3d cp = p - tr.c;
+    const double d5 = ab.dot(cp);
+    const double d6 = ac.dot(cp);
+    if (d6 >= 0.0 && d5 <= d6) {
+        return tr.c;
+    }
+
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        return tr.a + (d2 / (d2 - d6)) * ac;
+    }
+
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+        return tr.b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (tr.c - tr.b);
+    }
+
+    const double denom = 1.0 / (va + vb + vc);
+    return tr.a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/// \brief Test whether a triangle intersects any triangle in a set
+bool IntersectsAny(
+    const Triangle& tr,
+    const TriangleArray& triangles,
+    double eps)
+{
+    const Eigen::Vector3d n = (tr.b - tr.a).cross(tr.c - tr.a);
+    if (n.squaredNorm() == 0.0) {
+        return false;
+    }
+    const double d = -n.dot(tr.a);
+    const double e = eps * n.norm();
+
+    unsigned char candidates[INTERSECT_BLOCK_SIZE];
+    for (size_t begin = 0; begin < triangles.size(); begin += INTERSECT_BLOCK_SIZE) {
+        const size_t count =
+                std::min(INTERSECT_BLOCK_SIZE, triangles.size() - begin);
+        if (RejectSeparated(triangles, begin, count, n, d, e, candidates) == 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            if (candidates[i] &&
+                Intersects(tr, n, d, triangles[begin + i], eps))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+} // namespace sbpl
@@ -0,0 +1,327 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <sbpl_geometry_utils/mesh_io.h>
+
+// standard includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+// system includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sbpl {
+
+static const size_t STL_HEADER_SIZE = 84;
+static const size_t STL_RECORD_SIZE = 50;
+
+///////////////
+// StlReader //
+///////////////
+
+StlReader::StlReader() :
+    m_fd(-1),
+    m_data(nullptr),
+    m_size(0),
+    m_count(0),
+    m_next(0),
+    m_released(0),
+    m_ascii()
+{
+}
+
+StlReader::~StlReader()
+{
+    close();
+}
+
+/// \brief Open an STL file for reading
+///
+/// Files whose size matches the triangle count in their header are read as
+/// binary STL; other files beginning with "solid" are read as ASCII STL.
+bool StlReader::open(const std::string& path)
+{
+    close();
+
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd == -1) {
+        std::cerr << "Failed to open STL file '" << path << "'" << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) == -1) {
+        std::cerr << "Failed to stat STL file '" << path << "'" << std::endl;
+        close();
+        return false;
+    }
+
+    m_size = (size_t)st.st_size;
+    if (m_size >= STL_HEADER_SIZE) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (data == MAP_FAILED) {
+            std::cerr << "Failed to map STL file '" << path << "'" << std::endl;
+            close();
+            return false;
+        }
+        m_data = (const unsigned char*)data;
+
+        std::uint32_t count;
+        memcpy(&count, m_data + 80, sizeof(count));
+        if (STL_HEADER_SIZE + STL_RECORD_SIZE * (size_t)count == m_size) {
+            m_count = count;
+            madvise(data, m_size, MADV_SEQUENTIAL);
+            return true;
+        }
+    }
+
+    // not a binary STL; fall back to parsing it as text
+    const bool solid = m_data != nullptr && m_size >= 5 &&
+            memcmp(m_data, "solid", 5) == 0;
+    close();
+    if (!solid) {
+        std::cerr << "Malformed STL file '" << path << "'" << std::endl;
+        return false;
+    }
+
+    m_ascii.open(path.c_str());
+    if (!m_ascii.is_open()) {
+        std::cerr << "Failed to open STL file '" << path << "'" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void StlReader::close()
+{
+    if (m_data) {
+        munmap((void*)m_data, m_size);
+    }
+    if (m_fd != -1) {
+        ::close(m_fd);
+    }
+    if (m_ascii.is_open()) {
+        m_ascii.close();
+    }
+    m_fd = -1;
+    m_data = nullptr;
+    m_size = 0;
+    m_count = 0;
+    m_next = 0;
+    m_released = 0;
+}
+
+bool StlReader::isOpen() const
+{
+    return m_data != nullptr || m_ascii.is_open();
+}
+
+/// \brief Read the next chunk of triangles
+///
+/// Up to max_count triangles are appended to the output vector.
+///
+/// \return The number of triangles read; 0 once the file is exhausted
+size_t StlReader::read(size_t max_count, std::vector<Triangle>& triangles)
+{
+    if (m_data) {
+        return readBinary(max_count, triangles);
+    }
+    else if (m_ascii.is_open()) {
+        return readAscii(max_count, triangles);
+    }
+    return 0;
+}
+
+size_t StlReader::readBinary(size_t max_count, std::vector<Triangle>& triangles)
+{
+    const size_t count = std::min(max_count, m_count - m_next);
+    triangles.reserve(triangles.size() + count);
+    for (size_t i = 0; i < count; ++i, ++m_next) {
+        // skip the facet normal and read the three vertices
+        float v[9];
+        memcpy(v, m_data + STL_HEADER_SIZE + STL_RECORD_SIZE * m_next + 12, sizeof(v));
+        triangles.push_back(Triangle(
+                Eigen::Vector3d(v[0], v[1], v[2]),
+                Eigen::Vector3d(v[3], v[4], v[5]),
+                Eigen::Vector3d(v[6], v[7], v[8])));
+    }
+
+    // release the pages that have been fully consumed
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t consumed = STL_HEADER_SIZE + STL_RECORD_SIZE * m_next;
+    const size_t release = (consumed / page_size) * page_size;
+    if (release > m_released) {
+        madvise((void*)(m_data + m_released), release - m_released, MADV_DONTNEED);
+        m_released = release;
+    }
+
+    return count;
+}
+
+size_t StlReader::readAscii(size_t max_count, std::vector<Triangle>& triangles)
+{
+    size_t count = 0;
+    Eigen::Vector3d v[3];
+    int vcount = 0;
+    std::string token;
+    while (count < max_count && m_ascii >> token) {
+        if (token == "vertex") {
+            m_ascii >> v[vcount].x() >> v[vcount].y() >> v[vcount].z();
+            if (!m_ascii) {
+                std::cerr << "Malformed vertex in ASCII STL file" << std::endl;
+                return count;
+            }
+            if (++vcount == 3) {
+                triangles.push_back(Triangle(v[0], v[1], v[2]));
+                ++count;
+                vcount = 0;
+            }
+        }
+        else if (token == "endfacet") {
+            vcount = 0;
+        }
+    }
+    return count;
+}
+
+///////////////
+// ObjReader //
+///////////////
+
+ObjReader::ObjReader() :
+    m_file(),
+    m_vertices(),
+    m_pending(),
+    m_pending_next(0)
+{
+}
+
+bool ObjReader::open(const std::string& path)
+{
+    close();
+    m_file.open(path.c_str());
+    if (!m_file.is_open()) {
+        std::cerr << "Failed to open OBJ file '" << path << "'" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ObjReader::close()
+{
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+    m_vertices.clear();
+    m_pending.clear();
+    m_pending_next = 0;
+}
+
+/// \brief Read the next chunk of triangles
+///
+/// Up to max_count triangles are appended to the output vector.
+///
+/// \return The number of triangles read; 0 once the file is exhausted
+size_t ObjReader::read(size_t max_count, std::vector<Triangle>& triangles)
+{
+    size_t count = 0;
+    std::string line;
+    std::vector<int> face;
+    while (count < max_count) {
+        if (m_pending_next < m_pending.size()) {
+            triangles.push_back(m_pending[m_pending_next++]);
+            ++count;
+            continue;
+        }
+
+        if (!std::getline(m_file, line)) {
+            break;
+        }
+
+        if (line.size() < 2 || line[1] != ' ') {
+            continue;
+        }
+
+        if (line[0] == 'v') {
+            Eigen::Vector3f v;
+            if (sscanf(line.c_str() + 2, "%f %f %f", &v.x(), &v.y(), &v.z()) != 3) {
+                std::cerr << "Malformed vertex in OBJ file" << std::endl;
+                continue;
+            }
+            m_vertices.push_back(v);
+        }
+        else if (line[0] == 'f') {
+            face.clear();
+            const char* s = line.c_str() + 2;
+            char* end;
+            bool valid = true;
+            for (long i = strtol(s, &end, 10); end != s; i = strtol(s, &end, 10)) {
+                // obj indices are 1-based; negative indices count back from
+                // the most recent vertex
+                const long index = i < 0 ? (long)m_vertices.size() + i : i - 1;
+                if (index < 0 || index >= (long)m_vertices.size()) {
+                    valid = false;
+                    break;
+                }
+                face.push_back((int)index);
+
+                // skip texture and normal indices
+                s = end;
+                while (*s != '\0' && *s != ' ' && *s != '\t') {
+                    ++s;
+                }
+            }
+
+            if (!valid || face.size() < 3) {
+                std::cerr << "Malformed face in OBJ file" << std::endl;
+                continue;
+            }
+
+            m_pending.clear();
+            m_pending_next = 0;
+            const Eigen::Vector3d a = m_vertices[face[0]].cast<double>();
+            for (size_t j = 1; j + 1 < face.size(); ++j) {
+                m_pending.push_back(Triangle(
+                        a,
+                        m_vertices[face[j]].cast<double>(),
+                        m_vertices[face[j + 1]].cast<double>()));
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace sbpl
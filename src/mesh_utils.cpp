@@ -503,4 +503,60 @@ void CreateBoxMesh(
     vertices.push_back(f);
 }
 
+/// \brief Simplify a mesh for voxelization at a given resolution
+///
+/// Vertices are clustered by the cells of the voxel grid that VoxelizeMesh
+/// would construct at this resolution. Output vertices and indices are appended
+/// to the output vectors.
+void SimplifyMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    std::vector<Eigen::Vector3d>& simple_vertices,
+    std::vector<int>& simple_indices)
+{
+    const HalfResDiscretizer disc(res);
+    ClusterMeshVertices(
+            vertices,
+            indices,
+            [&](const Eigen::Vector3d& v)
+            {
+                return GridCoord(
+                        disc.discretize(v.x()),
+                        disc.discretize(v.y()),
+                        disc.discretize(v.z()));
+            },
+            simple_vertices,
+            simple_indices);
+}
+
+/// \brief Simplify a mesh for voxelization at a given resolution using a
+///     specified origin for the voxel grid
+///
+/// Output vertices and indices are appended to the output vectors.
+void SimplifyMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    std::vector<Eigen::Vector3d>& simple_vertices,
+    std::vector<int>& simple_indices)
+{
+    const PivotDiscretizer x_disc(res, voxel_origin.x());
+    const PivotDiscretizer y_disc(res, voxel_origin.y());
+    const PivotDiscretizer z_disc(res, voxel_origin.z());
+    ClusterMeshVertices(
+            vertices,
+            indices,
+            [&](const Eigen::Vector3d& v)
+            {
+                return GridCoord(
+                        x_disc.discretize(v.x()),
+                        y_disc.discretize(v.y()),
+                        z_disc.discretize(v.z()));
+            },
+            simple_vertices,
+            simple_indices);
+}
+
 } // namespace sbpl
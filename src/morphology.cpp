@@ -0,0 +1,416 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <sbpl_geometry_utils/morphology.h>
+
+// standard includes
+#include <algorithm>
+#include <limits>
+
+namespace sbpl {
+
+typedef PackedVoxelGrid::word_type word_type;
+
+//////////////////////////////////
+// Static Function Declarations //
+//////////////////////////////////
+
+static void ShiftRowUp(
+    const word_type* src, word_type* dst, int words, int shift);
+
+static void ShiftRowDown(
+    const word_type* src, word_type* dst, int words, int shift);
+
+static void DilateZ(PackedVoxelGrid& grid, int radius);
+static void DilateY(PackedVoxelGrid& grid, int radius);
+static void DilateX(PackedVoxelGrid& grid, int radius);
+
+static void DilateBox(PackedVoxelGrid& grid, int radius);
+static void DilateCross(PackedVoxelGrid& grid, int radius);
+static void OrInto(PackedVoxelGrid& dst, const PackedVoxelGrid& src);
+
+static void DistanceTransform1D(
+    const double* f, int n, double spacing,
+    double* d, int* v, double* z);
+
+/////////////////////////////////
+// Static Function Definitions //
+/////////////////////////////////
+
+// dst[z] = src[z - shift], shifting in zeros
+void ShiftRowUp(const word_type* src, word_type* dst, int words, int shift)
+{
+    const int wshift = shift / PackedVoxelGrid::WORD_BITS;
+    const int bshift = shift % PackedVoxelGrid::WORD_BITS;
+    for (int i = words - 1; i >= 0; --i) {
+        const int j = i - wshift;
+        word_type w = 0;
+        if (j >= 0) {
+            w = src[j] << bshift;
+            if (bshift != 0 && j > 0) {
+                w |= src[j - 1] >> (PackedVoxelGrid::WORD_BITS - bshift);
+            }
+        }
+        dst[i] = w;
+    }
+}
+
+// dst[z] = src[z + shift], shifting in zeros
+void ShiftRowDown(const word_type* src, word_type* dst, int words, int shift)
+{
+    const int wshift = shift / PackedVoxelGrid::WORD_BITS;
+    const int bshift = shift % PackedVoxelGrid::WORD_BITS;
+    for (int i = 0; i < words; ++i) {
+        const int j = i + wshift;
+        word_type w = 0;
+        if (j < words) {
+            w = src[j] >> bshift;
+            if (bshift != 0 && j + 1 < words) {
+                w |= src[j + 1] << (PackedVoxelGrid::WORD_BITS - bshift);
+            }
+        }
+        dst[i] = w;
+    }
+}
+
+// Each dilation pass grows the covered interval by doubling, so a radius r
+// dilation along an axis requires O(log r) shifted ORs rather than O(r).
+
+void DilateZ(PackedVoxelGrid& grid, int radius)
+{
+    const int words = grid.wordsPerRow();
+    const word_type mask = grid.lastWordMask();
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < grid.sizeX(); ++x) {
+        std::vector<word_type> orig(words);
+        std::vector<word_type> shifted(words);
+        for (int y = 0; y < grid.sizeY(); ++y) {
+            word_type* row = grid.row(x, y);
+            int covered = 0;
+            while (covered < radius) {
+                const int step = std::min(covered + 1, radius - covered);
+                std::copy(row, row + words, orig.begin());
+                ShiftRowUp(orig.data(), shifted.data(), words, step);
+                for (int i = 0; i < words; ++i) {
+                    row[i] |= shifted[i];
+                }
+                ShiftRowDown(orig.data(), shifted.data(), words, step);
+                for (int i = 0; i < words; ++i) {
+                    row[i] |= shifted[i];
+                }
+                covered += step;
+            }
+            row[words - 1] &= mask;
+        }
+    }
+}
+
+void DilateY(PackedVoxelGrid& grid, int radius)
+{
+    const int words = grid.wordsPerRow();
+    const int sy = grid.sizeY();
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < grid.sizeX(); ++x) {
+        std::vector<word_type> orig((size_t)sy * words);
+        word_type* slab = grid.row(x, 0);
+        int covered = 0;
+        while (covered < radius) {
+            const int step = std::min(covered + 1, radius - covered);
+            std::copy(slab, slab + (size_t)sy * words, orig.begin());
+            for (int y = 0; y < sy; ++y) {
+                word_type* row = slab + (size_t)y * words;
+                if (y - step >= 0) {
+                    const word_type* src = &orig[(size_t)(y - step) * words];
+                    for (int i = 0; i < words; ++i) {
+                        row[i] |= src[i];
+                    }
+                }
+                if (y + step < sy) {
+                    const word_type* src = &orig[(size_t)(y + step) * words];
+                    for (int i = 0; i < words; ++i) {
+                        row[i] |= src[i];
+                    }
+                }
+            }
+            covered += step;
+        }
+    }
+}
+
+void DilateX(PackedVoxelGrid& grid, int radius)
+{
+    const int words = grid.wordsPerRow();
+    const int sx = grid.sizeX();
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int y = 0; y < grid.sizeY(); ++y) {
+        std::vector<word_type> orig((size_t)sx * words);
+        int covered = 0;
+        while (covered < radius) {
+            const int step = std::min(covered + 1, radius - covered);
+            for (int x = 0; x < sx; ++x) {
+                const word_type* row = grid.row(x, y);
+                std::copy(row, row + words, &orig[(size_t)x * words]);
+            }
+            for (int x = 0; x < sx; ++x) {
+                word_type* row = grid.row(x, y);
+                if (x - step >= 0) {
+                    const word_type* src = &orig[(size_t)(x - step) * words];
+                    for (int i = 0; i < words; ++i) {
+                        row[i] |= src[i];
+                    }
+                }
+                if (x + step < sx) {
+                    const word_type* src = &orig[(size_t)(x + step) * words];
+                    for (int i = 0; i < words; ++i) {
+                        row[i] |= src[i];
+                    }
+                }
+            }
+            covered += step;
+        }
+    }
+}
+
+void DilateBox(PackedVoxelGrid& grid, int radius)
+{
+    DilateZ(grid, radius);
+    DilateY(grid, radius);
+    DilateX(grid, radius);
+}
+
+void DilateCross(PackedVoxelGrid& grid, int radius)
+{
+    PackedVoxelGrid y_arm(grid);
+    PackedVoxelGrid x_arm(grid);
+    DilateZ(grid, radius);
+    DilateY(y_arm, radius);
+    DilateX(x_arm, radius);
+    OrInto(grid, y_arm);
+    OrInto(grid, x_arm);
+}
+
+void OrInto(PackedVoxelGrid& dst, const PackedVoxelGrid& src)
+{
+    const size_t n = (size_t)dst.sizeX() * dst.sizeY() * dst.wordsPerRow();
+    word_type* d = dst.data();
+    const word_type* s = src.data();
+    for (size_t i = 0; i < n; ++i) {
+        d[i] |= s[i];
+    }
+}
+
+// Felzenszwalb and Huttenlocher's lower envelope of parabolas, computing
+// d[p] = min_q (spacing * (p - q))^2 + f[q]
+void DistanceTransform1D(
+    const double* f, int n, double spacing,
+    double* d, int* v, double* z)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double s2 = spacing * spacing;
+
+    // find the first finite sample
+    int first = 0;
+    while (first < n && f[first] == inf) {
+        ++first;
+    }
+    if (first == n) {
+        std::fill(d, d + n, inf);
+        return;
+    }
+
+    int k = 0;
+    v[0] = first;
+    z[0] = -inf;
+    z[1] = inf;
+    for (int q = first + 1; q < n; ++q) {
+        if (f[q] == inf) {
+            continue;
+        }
+        double s;
+        while (true) {
+            const int p = v[k];
+            s = ((f[q] + s2 * q * q) - (f[p] + s2 * p * p)) / (2.0 * s2 * (q - p));
+            if (s <= z[k] && k > 0) {
+                --k;
+            }
+            else {
+                break;
+            }
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = inf;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        const double dq = spacing * (q - v[k]);
+        d[q] = dq * dq + f[v[k]];
+    }
+}
+
+/////////////////////////////////
+// Public Function Definitions //
+/////////////////////////////////
+
+/// \brief Dilate a packed occupancy grid
+///
+/// Cells outside the grid are treated as empty. Box and cross dilations are
+/// computed as separable passes along each axis; the sphere is approximated
+/// by alternating unit cross and box dilations.
+void DilateVoxels(
+    PackedVoxelGrid& grid,
+    int radius,
+    StructuringElement element)
+{
+    if (radius <= 0 || grid.sizeX() == 0 || grid.sizeY() == 0 || grid.sizeZ() == 0) {
+        return;
+    }
+
+    switch (element) {
+    case StructuringElement::Box:
+        DilateBox(grid, radius);
+        break;
+    case StructuringElement::Cross:
+        DilateCross(grid, radius);
+        break;
+    case StructuringElement::Sphere:
+        for (int i = 0; i < radius; ++i) {
+            if (i % 2 == 0) {
+                DilateCross(grid, 1);
+            }
+            else {
+                DilateBox(grid, 1);
+            }
+        }
+        break;
+    }
+}
+
+/// \brief Erode a packed occupancy grid
+///
+/// Erosion is computed as the complement of the dilation of the complement.
+/// Cells outside the grid do not contribute, so the grid boundary does not
+/// erode occupied cells adjacent to it.
+void ErodeVoxels(
+    PackedVoxelGrid& grid,
+    int radius,
+    StructuringElement element)
+{
+    grid.flip();
+    DilateVoxels(grid, radius, element);
+    grid.flip();
+}
+
+/// \brief Compute the exact squared Euclidean distance from each cell center
+///     to the nearest occupied cell center
+///
+/// Cells are spaced by the given per-axis spacing. If no cell is occupied, all
+/// distances are infinite. Distances are stored in memory index order.
+void SquaredDistanceTransform(
+    const PackedVoxelGrid& sites,
+    const Eigen::Vector3d& spacing,
+    std::vector<double>& d2)
+{
+    const int sx = sites.sizeX();
+    const int sy = sites.sizeY();
+    const int sz = sites.sizeZ();
+    const double inf = std::numeric_limits<double>::infinity();
+
+    d2.resize((size_t)sx * sy * sz);
+
+    // pass along z
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < sx; ++x) {
+        std::vector<double> f(sz);
+        std::vector<int> v(sz);
+        std::vector<double> z(sz + 1);
+        for (int y = 0; y < sy; ++y) {
+            for (int k = 0; k < sz; ++k) {
+                f[k] = sites.test(x, y, k) ? 0.0 : inf;
+            }
+            double* d = &d2[((size_t)x * sy + y) * sz];
+            DistanceTransform1D(f.data(), sz, spacing.z(), d, v.data(), z.data());
+        }
+    }
+
+    // pass along y
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int x = 0; x < sx; ++x) {
+        std::vector<double> f(sy);
+        std::vector<double> d(sy);
+        std::vector<int> v(sy);
+        std::vector<double> z(sy + 1);
+        for (int k = 0; k < sz; ++k) {
+            for (int y = 0; y < sy; ++y) {
+                f[y] = d2[((size_t)x * sy + y) * sz + k];
+            }
+            DistanceTransform1D(f.data(), sy, spacing.y(), d.data(), v.data(), z.data());
+            for (int y = 0; y < sy; ++y) {
+                d2[((size_t)x * sy + y) * sz + k] = d[y];
+            }
+        }
+    }
+
+    // pass along x
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int y = 0; y < sy; ++y) {
+        std::vector<double> f(sx);
+        std::vector<double> d(sx);
+        std::vector<int> v(sx);
+        std::vector<double> z(sx + 1);
+        for (int k = 0; k < sz; ++k) {
+            for (int x = 0; x < sx; ++x) {
+                f[x] = d2[((size_t)x * sy + y) * sz + k];
+            }
+            DistanceTransform1D(f.data(), sx, spacing.x(), d.data(), v.data(), z.data());
+            for (int x = 0; x < sx; ++x) {
+                d2[((size_t)x * sy + y) * sz + k] = d[x];
+            }
+        }
+    }
+}
+
+} // namespace sbpl
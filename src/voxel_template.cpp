@@ -0,0 +1,249 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <sbpl_geometry_utils/voxel_template.h>
+
+// standard includes
+#include <math.h>
+#include <algorithm>
+
+namespace sbpl {
+
+typedef PackedVoxelGrid::word_type word_type;
+
+//////////////////////////////////
+// Static Function Declarations //
+//////////////////////////////////
+
+static word_type ExtractWord(const word_type* row, int words, int bit);
+
+/////////////////////////////////
+// Static Function Definitions //
+/////////////////////////////////
+
+// Return the 64 bits of a row starting at an arbitrary, possibly negative, bit
+// position, with bits outside the row reading as zero
+word_type ExtractWord(const word_type* row, int words, int bit)
+{
+    const int B = PackedVoxelGrid::WORD_BITS;
+    const int w = bit >= 0 ? bit / B : -((-bit + B - 1) / B);
+    const int b = bit - w * B;
+    const word_type lo = (w >= 0 && w < words) ? row[w] : 0;
+    if (b == 0) {
+        return lo;
+    }
+    const word_type hi = (w + 1 >= 0 && w + 1 < words) ? row[w + 1] : 0;
+    return (lo >> b) | (hi << (B - b));
+}
+
+/////////////////////////////////
+// Public Function Definitions //
+/////////////////////////////////
+
+VoxelTemplate::VoxelTemplate() :
+    m_size_x(0),
+    m_size_y(0),
+    m_size_z(0),
+    m_voxel_count(0),
+    m_origin(Eigen::Vector3d::Zero()),
+    m_rows(),
+    m_bits()
+{
+}
+
+VoxelTemplate::VoxelTemplate(
+    const std::vector<Eigen::Vector3d>& voxels,
+    double res)
+:
+    VoxelTemplate()
+{
+    build(voxels, res);
+}
+
+/// \brief Build the template from a set of voxel centers
+///
+/// The voxel centers, such as those produced by VoxelizeMesh, are expected to
+/// lie on a lattice of the given resolution; the template origin is placed at
+/// the minimum corner of their bounding box. Duplicate voxels are merged.
+void VoxelTemplate::build(const std::vector<Eigen::Vector3d>& voxels, double res)
+{
+    m_rows.clear();
+    m_bits.clear();
+    m_size_x = m_size_y = m_size_z = 0;
+    m_voxel_count = 0;
+    m_origin = Eigen::Vector3d::Zero();
+    if (voxels.empty()) {
+        return;
+    }
+
+    Eigen::Vector3d min = voxels.front();
+    for (const Eigen::Vector3d& v : voxels) {
+        min = min.cwiseMin(v);
+    }
+    m_origin = min;
+
+    std::vector<MemoryCoord> cells(voxels.size());
+    for (size_t i = 0; i < voxels.size(); ++i) {
+        const Eigen::Vector3d d = (voxels[i] - min) / res;
+        cells[i] = MemoryCoord(
+                (int)floor(d.x() + 0.5),
+                (int)floor(d.y() + 0.5),
+                (int)floor(d.z() + 0.5));
+        m_size_x = std::max(m_size_x, cells[i].x + 1);
+        m_size_y = std::max(m_size_y, cells[i].y + 1);
+        m_size_z = std::max(m_size_z, cells[i].z + 1);
+    }
+
+    // group cells into z-rows
+    std::sort(cells.begin(), cells.end(),
+            [](const MemoryCoord& a, const MemoryCoord& b)
+            {
+                if (a.x != b.x) return a.x < b.x;
+                if (a.y != b.y) return a.y < b.y;
+                return a.z < b.z;
+            });
+
+    const int B = PackedVoxelGrid::WORD_BITS;
+    size_t i = 0;
+    while (i < cells.size()) {
+        size_t j = i;
+        while (j < cells.size() &&
+            cells[j].x == cells[i].x && cells[j].y == cells[i].y)
+        {
+            ++j;
+        }
+
+        Row row;
+        row.x = cells[i].x;
+        row.y = cells[i].y;
+        row.z = cells[i].z;
+        row.words = (cells[j - 1].z - row.z) / B + 1;
+        row.first_word = (int)m_bits.size();
+        m_bits.resize(m_bits.size() + row.words, 0);
+        for (size_t k = i; k < j; ++k) {
+            const int bit = cells[k].z - row.z;
+            word_type& w = m_bits[row.first_word + bit / B];
+            const word_type mask = word_type(1) << (bit % B);
+            if (!(w & mask)) {
+                w |= mask;
+                ++m_voxel_count;
+            }
+        }
+        m_rows.push_back(row);
+        i = j;
+    }
+}
+
+template <typename Visitor>
+bool VoxelTemplate::visitOverlaps(
+    const PackedVoxelGrid& env,
+    const MemoryCoord& offset,
+    Visitor visit) const
+{
+    const int words = env.wordsPerRow();
+    for (const Row& row : m_rows) {
+        const int x = offset.x + row.x;
+        const int y = offset.y + row.y;
+        if (x < 0 || x >= env.sizeX() || y < 0 || y >= env.sizeY()) {
+            continue;
+        }
+
+        const word_type* env_row = env.row(x, y);
+        const int z = offset.z + row.z;
+        for (int k = 0; k < row.words; ++k) {
+            const word_type hits = m_bits[row.first_word + k] &
+                    ExtractWord(env_row, words, z + k * PackedVoxelGrid::WORD_BITS);
+            if (hits && !visit(hits)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// \brief Return whether any template voxel overlaps an occupied environment
+///     cell, stopping at the first overlap
+bool VoxelTemplate::collides(
+    const PackedVoxelGrid& env,
+    const MemoryCoord& offset) const
+{
+    return !visitOverlaps(env, offset, [](word_type) { return false; });
+}
+
+/// \brief Return the number of template voxels that overlap occupied
+///     environment cells
+int VoxelTemplate::overlapCount(
+    const PackedVoxelGrid& env,
+    const MemoryCoord& offset) const
+{
+    int count = 0;
+    visitOverlaps(env, offset, [&](word_type hits)
+    {
+        count += __builtin_popcountll(hits);
+        return true;
+    });
+    return count;
+}
+
+/// \brief Test the template against the environment at each of a list of
+///     offsets
+///
+/// Each test stops at its first overlap. Offsets are evaluated in parallel.
+void VoxelTemplate::collides(
+    const PackedVoxelGrid& env,
+    const std::vector<MemoryCoord>& offsets,
+    std::vector<bool>& collisions) const
+{
+    std::vector<unsigned char> results(offsets.size());
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (int i = 0; i < (int)offsets.size(); ++i) {
+        results[i] = collides(env, offsets[i]);
+    }
+    collisions.assign(results.begin(), results.end());
+}
+
+/// \brief Return the index of the first offset at which the template does not
+///     collide with the environment, or -1 if it collides at every offset
+///
+/// Offsets are tested in order and testing stops at the first free offset.
+int VoxelTemplate::firstCollisionFree(
+    const PackedVoxelGrid& env,
+    const std::vector<MemoryCoord>& offsets) const
+{
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        if (!collides(env, offsets[i])) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+} // namespace sbpl
@@ -34,8 +34,10 @@
 #include <stdio.h>
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 // project includes
+#include <sbpl_geometry_utils/intersect.h>
 #include <sbpl_geometry_utils/mesh_utils.h>
 
 namespace sbpl {
@@ -44,54 +46,79 @@ namespace sbpl {
 // Static Function Declarations //
 //////////////////////////////////
 
-template <typename Discretizer>
-static void VoxelizeMesh(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& indices,
-    VoxelGrid<Discretizer>& vg,
-    bool fill = false);
-
-template <typename Discretizer>
-static void VoxelizeMeshAwesome(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& indices,
-    VoxelGrid<Discretizer>& vg);
-
 template <typename Discretizer>
 void VoxelizeMeshNaive(
     const std::vector<Eigen::Vector3d>& vertices,
     const std::vector<int>& triangles,
     VoxelGrid<Discretizer>& vg);
 
-template <typename Discretizer>
-void ExtractVoxels(
-    const VoxelGrid<Discretizer>& vg,
-    std::vector<Eigen::Vector3d>& voxels);
-
 static bool IsInDiscreteBoundingBox(
     const MemoryCoord& mc,
     const MemoryCoord& minmc,
     const MemoryCoord& maxmc);
 
-static bool Intersects(
-    const Triangle& tr1,
-    const Triangle& tr2,
-    double eps = 1.0e-4);
-
 bool PointOnTriangle(
     const Eigen::Vector3d& p,
     const Eigen::Vector3d& a,
     const Eigen::Vector3d& b,
     const Eigen::Vector3d& c);
 
-/// \brief Fill the interior of a voxel grid via scanning
-template <typename Discretizer>
-static void ScanFill(VoxelGrid<Discretizer>& vg);
-
 static void TransformVertices(
     const Eigen::Affine3d& transform,
     std::vector<Eigen::Vector3d>& vertices);
 
+static void CreatePosedBoxMesh(
+    double length,
+    double width,
+    double height,
+    const Eigen::Affine3d& pose,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& triangles);
+
+static void CreatePosedSphereMesh(
+    double radius,
+    const Eigen::Affine3d& pose,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& triangles);
+
+static void CreatePosedCylinderMesh(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& triangles);
+
+static void CreatePosedConeMesh(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& triangles);
+
+static bool ComputeRegionBounds(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    bool fill,
+    Eigen::Vector3d& min,
+    Eigen::Vector3d& max);
+
+template <typename Discretizer>
+static void ExtractVoxelsInRegion(
+    const VoxelGrid<Discretizer>& vg,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels);
+
+static bool VoxelizeSphereListKeys(
+    const std::vector<double>& radii,
+    const std::vector<Eigen::Affine3d>& poses,
+    double res,
+    std::vector<VoxelKey>& keys,
+    bool fill,
+    Separability sep);
+
 static double Distance(const Eigen::Vector3d& n, double d, const Eigen::Vector3d& x);
 
 double Distance(
@@ -108,40 +135,6 @@ static bool CompareZ(const Eigen::Vector3d& u, const Eigen::Vector3d& v);
 // Static Function Definitions //
 /////////////////////////////////
 
-template <typename Discretizer>
-static void VoxelizeMesh(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& indices,
-    VoxelGrid<Discretizer>& vg,
-    bool fill)
-{
-    const bool awesome = true;
-    if (awesome) {
-        VoxelizeMeshAwesome(vertices, indices, vg);
-    }
-    else {
-        VoxelizeMeshNaive(vertices, indices, vg);
-    }
-
-    if (fill) {
-        ScanFill(vg);
-    }
-}
-
-template <typename Discretizer>
-void VoxelizeMeshAwesome(
-    const std::vector<Eigen::Vector3d>& vertices,
-    const std::vector<int>& indices,
-    VoxelGrid<Discretizer>& vg)
-{
-    for (int i = 0; i < (int)indices.size() / 3; i++) {
-        const Eigen::Vector3d& a = vertices[indices[3 * i + 0]];
-        const Eigen::Vector3d& b = vertices[indices[3 * i + 1]];
-        const Eigen::Vector3d& c = vertices[indices[3 * i + 2]];
-        VoxelizeTriangle(a, b, c, vg);
-    }
-}
-
 template <typename Discretizer>
 void VoxelizeMeshNaive(
     const std::vector<Eigen::Vector3d>& vertices,
@@ -200,24 +193,6 @@ void VoxelizeMeshNaive(
     }
 }
 
-template <typename Discretizer>
-void ExtractVoxels(
-    const VoxelGrid<Discretizer>& vg,
-    std::vector<Eigen::Vector3d>& voxels)
-{
-    for (int x = 0; x < vg.sizeX(); x++) {
-        for (int y = 0; y < vg.sizeY(); y++) {
-            for (int z = 0; z < vg.sizeZ(); z++) {
-                MemoryCoord mc(x, y, z);
-                if (vg[mc]) {
-                    WorldCoord wc = vg.memoryToWorld(mc);
-                    voxels.push_back(Eigen::Vector3d(wc.x, wc.y, wc.z));
-                }
-            }
-        }
-    }
-}
-
 bool ComputeAxisAlignedBoundingBox(
     const std::vector<Eigen::Vector3d>& vertices,
     Eigen::Vector3d& min,
@@ -267,276 +242,6 @@ bool IsInDiscreteBoundingBox(
     return inside;
 }
 
-bool Intersects(const Triangle& tr1, const Triangle& tr2, double eps)
-{
-    // Vertices 0, 1, and 2 on triangle 1
-    Eigen::Vector3d v10(tr1.a.x(), tr1.a.y(), tr1.a.z());
-    Eigen::Vector3d v11(tr1.b.x(), tr1.b.y(), tr1.b.z());
-    Eigen::Vector3d v12(tr1.c.x(), tr1.c.y(), tr1.c.z());
-
-    // Vertices 0, 1, and 2 on triangle 2
-    Eigen::Vector3d v20(tr2.a.x(), tr2.a.y(), tr2.a.z());
-    Eigen::Vector3d v21(tr2.b.x(), tr2.b.y(), tr2.b.z());
-    Eigen::Vector3d v22(tr2.c.x(), tr2.c.y(), tr2.c.z());
-
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Reject if Triangle 1's vertices are all on the same side of Triangle 2
-    ////////////////////////////////////////////////////////////////////////////////
-
-    // Calculate parameters for the plane in which triangle 2 lies
-    Eigen::Vector3d n2 = (v21 - v20).cross(v22 - v20);
-    n2.normalize();
-    double d2 = (-n2).dot(v20);
-
-    // The distances from the vertices of triangle 1 to the plane of triangle 2
-    double dv10 = n2.dot(v10) + d2;
-    double dv11 = n2.dot(v11) + d2;
-    double dv12 = n2.dot(v12) + d2;
-
-    // approx. dv10 != 0.0, dv11 != 0.0, dv12 != 0.0
-    if(fabs(dv10) > eps && fabs(dv11) > eps && fabs(dv12) > eps)
-    {
-        // all points lie to one side of the triangle
-        if((dv10 > 0 && dv11 > 0 && dv12 > 0) || (dv10 < 0 && dv11 < 0 && dv12 < 0))
-        {
-            return false;
-        }
-    }
-    else if(fabs(dv10) < eps && fabs(dv11) < eps && fabs(dv12) < eps)
-    {
-        ////////////////////////////////////////////////////////////////////////////////
-        /// Perform tests to see if coplanar triangles are in collision
-        ////////////////////////////////////////////////////////////////////////////////
-
-        // Project the coplanar triangles into the X-Y plane
-        std::vector<Eigen::Vector2d> firstTri2DVertices;
-        Eigen::Vector2d u1;
-        u1[0] = v10[0]; u1[1] = v10[1];
-        firstTri2DVertices.push_back(u1);
-        u1[0] = v11[0]; u1[1] = v11[1];
-        firstTri2DVertices.push_back(u1);
-        u1[0] = v12[0]; u1[1] = v12[1];
-        firstTri2DVertices.push_back(u1);
-
-        std::vector<Eigen::Vector2d> secondTri2DVertices;
-        Eigen::Vector2d u2;
-        u2[0] = v20[0]; u2[1] = v20[1];
-        secondTri2DVertices.push_back(u2);
-        u2[0] = v21[0]; u2[1] = v21[1];
-        secondTri2DVertices.push_back(u2);
-        u2[0] = v22[0]; u2[1] = v22[1];
-        secondTri2DVertices.push_back(u2);
-
-        ////////////////////////////////////////////////////////////////////////////////
-        /// Perform collision tests between two-dimensional line segments
-        ////////////////////////////////////////////////////////////////////////////////
-
-        for(int i = 0; i < 3; i++)
-        {
-            for(int j = 0; j < 3; j++)
-            {
-                // the points defining the first segment
-                const Eigen::Vector2d& pt1 = firstTri2DVertices[i];
-                const Eigen::Vector2d& pt2 = firstTri2DVertices[(i + 1) % 3];
-                // the points defining the second segment
-                const Eigen::Vector2d& pt3 = secondTri2DVertices[j];
-                const Eigen::Vector2d& pt4 = secondTri2DVertices[(j + 1) % 3];
-
-                double denom = (pt1[0] - pt2[0]) * (pt3[1] - pt4[1]) - (pt1[1] - pt2[1]) * (pt3[0] - pt4[0]);
-                double tmp1 = pt1[0] * pt2[1] - pt1[1] * pt2[0];
-                double tmp2 = pt3[0] * pt4[1] - pt3[1] * pt4[0];
-
-                // if lines arent parallel
-                if(fabs(denom) > eps)
-                {
-                    // the point of intersection between the two lines (from the segments)
-                    Eigen::Vector2d intersection;
-                    intersection[0] = tmp1 * (pt3[0] - pt4[0]) - (pt1[0] - pt2[0]) * tmp2;
-                    intersection[0] /= denom;
-                    intersection[1] = tmp1 * (pt3[1] - pt4[1]) - (pt1[1] - pt2[1]) * tmp2;
-                    intersection[1] /= denom;
-
-                    // check if the point of between the lines intersection lies on the line segments
-                    double vx1 = pt2[0] - pt1[0];
-                    double vx2 = pt4[0] - pt3[0];
-                    if((intersection[0] - pt1[0]) / vx1 >= 0 && (intersection[0] - pt1[0]) / vx1 <= 1.0 &&
-                       (intersection[0] - pt3[0]) / vx2 >= 0 && (intersection[0] - pt3[0]) / vx2 <= 1.0)
-                    {
-                        return true;
-                    }
-                }
-                else
-                {
-                    // ANDREW: bad assumption, they could be the same line
-                    //printf("Line segments are parallel and won't intersect\n");
-                }
-            }
-        }
-
-        ////////////////////////////////////////////////////////////////////////////////
-        /// Check for containment of one triangle within another
-        ////////////////////////////////////////////////////////////////////////////////
-
-        // compute center point of first triangle
-        Eigen::Vector2d firstTriangleCenter(0.0, 0.0);
-        for (int i = 0; i < 3; i++) {
-            firstTriangleCenter[0] += firstTri2DVertices[i][0];
-            firstTriangleCenter[1] += firstTri2DVertices[i][1];
-        }
-        firstTriangleCenter[0] /= 3;
-        firstTriangleCenter[1] /= 3;
-
-        // compute center point of second triangle
-        Eigen::Vector2d secondTriangleCenter(0.0, 0.0);
-        for (int i = 0; i < 3; i++) {
-            secondTriangleCenter[0] += secondTri2DVertices[i][0];
-            secondTriangleCenter[1] += secondTri2DVertices[i][1];
-        }
-        secondTriangleCenter[0] /= 3;
-        secondTriangleCenter[1] /= 3;
-
-        Eigen::Vector3d firstTriangleCenterTo3D(firstTriangleCenter[0], firstTriangleCenter[1], 0.0);
-        Eigen::Vector3d secondTriangleCenterTo3D(secondTriangleCenter[0], secondTriangleCenter[1], 0.0);
-        Eigen::Vector3d u10To3D(firstTri2DVertices[0][0], firstTri2DVertices[0][1], 0.0);
-        Eigen::Vector3d u11To3D(firstTri2DVertices[1][0], firstTri2DVertices[1][1], 0.0);
-        Eigen::Vector3d u12To3D(firstTri2DVertices[2][0], firstTri2DVertices[2][1], 0.0);
-        Eigen::Vector3d u20To3D(secondTri2DVertices[0][0], secondTri2DVertices[0][1], 0.0);
-        Eigen::Vector3d u21To3D(secondTri2DVertices[1][0], secondTri2DVertices[1][1], 0.0);
-        Eigen::Vector3d u22To3D(secondTri2DVertices[2][0], secondTri2DVertices[2][1], 0.0);
-
-        // Awesome code re-use
-        if(PointOnTriangle(firstTriangleCenterTo3D, u20To3D, u21To3D, u22To3D) ||
-           PointOnTriangle(secondTriangleCenterTo3D, u10To3D, u11To3D, u12To3D))
-        {
-            return true;
-        }
-
-        return false;
-    }
-    else
-    {
-        return false;
-    }
-
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Reject if Triangle 2's vertices are all on the same side of Triangle 1
-    ////////////////////////////////////////////////////////////////////////////////
-
-    // Calculate parameters for the plane in which triangle 1 lies
-    Eigen::Vector3d n1 = (v11 - v10).cross(v12 - v10);
-    n1.normalize();
-    double d1 = (-n1).dot(v10);
-
-    // The distances from the vertices of triangle 2 to the plane of triangle 1
-    double dv20 = n1.dot(v20) + d1;
-    double dv21 = n1.dot(v21) + d1;
-    double dv22 = n1.dot(v22) + d1;
-
-    // approx. dv20 != 0.0, dv21 != 0.0, dv22 != 0.0
-    if(fabs(dv20) > eps && fabs(dv21) > eps && fabs(dv22) > eps)
-    {
-        // all points lie to one side of the triangle
-        if((dv20 > 0 && dv21 > 0 && dv22 > 0) || (dv20 < 0 && dv21 < 0 && dv22 < 0))
-        {
-            return false;
-        }
-    }
-    else
-    {
-        // ANDREW: should be covered by coplanar case above
-        return false;
-    }
-
-    // The direction of the line of intersection between the two planes
-    Eigen::Vector3d D = n1.cross(n2);
-
-    ////////////////////////////////////////////////////////////////////////////////////////
-    /// Get the interval on the line where Triangle 1 Intersects
-    ////////////////////////////////////////////////////////////////////////////////////////
-
-    double t1;
-    double t2;
-
-    double pv10 = D.dot(v10);
-    double pv11 = D.dot(v11);
-    double pv12 = D.dot(v12);
-
-    // Vertex 0 of Triangle 1 is on the opposite side
-    if((dv10 > 0 && dv11 < 0 && dv12 < 0) || (dv10 < 0 && dv11 > 0 && dv12 > 0))
-    {
-        t1 = pv11 + (pv10 - pv11) * (dv11 / (dv11 - dv10));
-        t2 = pv12 + (pv10 - pv12) * (dv12 / (dv12 - dv10));
-    }
-    // Vertex 1 of Triangle 1 is on the opposite side
-    else if((dv11 > 0 && dv10 < 0 && dv12 < 0) || (dv11 < 0 && dv10 > 0 && dv12 > 0))
-    {
-        t1 = pv10 + (pv11 - pv10) * (dv10 / (dv10 - dv11));
-        t2 = pv12 + (pv11 - pv12) * (dv12 / (dv12 - dv11));
-    }
-    // Vertex 2 of triangle 1 is on the opposite side
-    else //if((dv12 > 0 && dv10 < 0 && dv11 < 0) || (dv12 < 0 && dv10 > 0 && dv11 > 0))
-    {
-        t1 = pv10 + (pv12 - pv10) * (dv10 / (dv10 - dv12));
-        t2 = pv11 + (pv12 - pv11) * (dv11 / (dv11 - dv12));
-    }
-
-    ////////////////////////////////////////////////////////////////////////////////////////
-    /// Get the interval on the line where Triangle 2 Intersects
-    ////////////////////////////////////////////////////////////////////////////////////////
-
-    double t3;
-    double t4;
-
-    double pv20 = D.dot(v20);
-    double pv21 = D.dot(v21);
-    double pv22 = D.dot(v22);
-
-    // Vertex 0 of Triangle 2 is on the opposite side
-    if((dv20 > 0 && dv21 < 0 && dv22 < 0) || (dv20 < 0 && dv21 > 0 && dv22 > 0))
-    {
-        t3 = pv21 + (pv20 - pv21) * (dv21 / (dv21 - dv20));
-        t4 = pv22 + (pv20 - pv22) * (dv22 / (dv22 - dv20));
-    }
-    // Vertex 1 of Triangle 2 is on the opposite side
-    else if((dv21 > 0 && dv20 < 0 && dv22 < 0) || (dv21 < 0 && dv20 > 0 && dv22 > 0))
-    {
-        t3 = pv20 + (pv21 - pv20) * (dv20 / (dv20 - dv21));
-        t4 = pv22 + (pv21 - pv22) * (dv22 / (dv22 - dv21));
-    }
-    // Vertex 2 of triangle 2 is on the opposite side
-    else //if((dv22 > 0 && dv20 < 0 && dv21 < 0) || (dv22 < 0 && dv20 > 0 && dv21 > 0))
-    {
-        t3 = pv20 + (pv22 - pv20) * (dv20 / (dv20 - dv22));
-        t4 = pv21 + (pv22 - pv21) * (dv21 / (dv21 - dv22));
-    }
-
-    ////////////////////////////////////////////////////////////////////////////////
-    /// Test for intersection of the above intervals
-    ////////////////////////////////////////////////////////////////////////////////
-
-    double temp = t1;
-    t1 = std::min(t1, t2);
-    t2 = std::max(temp, t2);
-
-    temp = t3;
-    t3 = std::min(t3, t4);
-    t4 = std::max(temp, t4);
-
-    // if intervals overlap, triangles intersect
-    bool overlap = false;
-    overlap |= (t3 <= t2 && t2 <= t4);
-    overlap |= (t3 <= t1 && t1 <= t4);
-    overlap |= (t1 <= t3 && t3 <= t2);
-    overlap |= (t1 <= t4 && t4 <= t2);
-
-    if(overlap)
-    {
-        return true;
-    }
-
-    return false;
-}
-
 bool PointOnTriangle(
     const Eigen::Vector3d& p,
     const Eigen::Vector3d& a,
@@ -568,60 +273,152 @@ bool PointOnTriangle(
     return false;
 }
 
-template <typename Discretizer>
-void ScanFill(VoxelGrid<Discretizer>& vg)
+void TransformVertices(
+    const Eigen::Affine3d& transform,
+    std::vector<Eigen::Vector3d>& vertices)
+{
+    for (size_t i = 0; i < vertices.size(); i++) {
+        vertices[i] = transform * vertices[i];
+    }
+}
+
+// Create the meshes of the primitive shapes at a given pose, tessellated as
+// their voxelizers tessellate them
+void CreatePosedBoxMesh(
+    double length,
+    double width,
+    double height,
+    const Eigen::Affine3d& pose,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& triangles)
 {
-    for (int x = 0; x < vg.sizeX(); x++) {
-        for (int y = 0; y < vg.sizeY(); y++) {
-            const int OUTSIDE = 0;
-            const int ON_BOUNDARY_FROM_OUTSIDE = 1;
-            const int INSIDE = 2;
-            const int ON_BOUNDARY_FROM_INSIDE = 4;
+    CreateIndexedBoxMesh(length, width, height, vertices, triangles);
+    TransformVertices(pose, vertices);
+}
 
-            int scan_state = OUTSIDE;
+void CreatePosedSphereMesh(
+    double radius,
+    const Eigen::Affine3d& pose,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& triangles)
+{
+    CreateIndexedSphereMesh(radius, 7, 8, vertices, triangles);
+    TransformVertices(pose, vertices);
+}
 
-            for (int z = 0; z < vg.sizeZ(); z++) {
-                if (scan_state == OUTSIDE && vg[MemoryCoord(x, y, z)]) {
-                    scan_state = ON_BOUNDARY_FROM_OUTSIDE;
-                }
-                else if (scan_state == ON_BOUNDARY_FROM_OUTSIDE &&
-                    !vg[MemoryCoord(x, y, z)])
-                {
-                    bool allEmpty = true;
-                    for (int l = z; l < vg.sizeZ(); l++) {
-                        allEmpty &= !vg[MemoryCoord(x, y, l)];
-                    }
-                    if (allEmpty) {
-                        scan_state = OUTSIDE;
-                    }
-                    else {
-                        scan_state = INSIDE;
-                        vg[MemoryCoord(x, y, z)] = true;
-                    }
-                }
-                else if (scan_state == INSIDE && !vg[MemoryCoord(x, y, z)]) {
-                    vg[MemoryCoord(x, y, z)] = true;
-                }
-                else if (scan_state == INSIDE && vg[MemoryCoord(x, y, z)]) {
-                    scan_state = ON_BOUNDARY_FROM_INSIDE;
-                }
-                else if (scan_state == ON_BOUNDARY_FROM_INSIDE &&
-                    !vg[MemoryCoord(x, y, z)])
-                {
-                    scan_state = OUTSIDE;
+void CreatePosedCylinderMesh(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& triangles)
+{
+    CreateIndexedCylinderMesh(radius, height, vertices, triangles);
+    TransformVertices(pose, vertices);
+}
+
+void CreatePosedConeMesh(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    std::vector<Eigen::Vector3d>& vertices,
+    std::vector<int>& triangles)
+{
+    CreateIndexedConeMesh(radius, height, vertices, triangles);
+    TransformVertices(pose, vertices);
+}
+
+// Compute the bounds of the grid needed to voxelize the part of a mesh within
+// a region, returning false if the mesh does not overlap the region. When
+// filling, the bounds span the mesh's full extent along z so that ScanFill
+// starts each scan outside the mesh.
+bool ComputeRegionBounds(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    bool fill,
+    Eigen::Vector3d& min,
+    Eigen::Vector3d& max)
+{
+    if (((int)indices.size()) % 3 != 0) {
+        std::cerr << "Incorrect indexed triangles format" << std::endl;
+        return false;
+    }
+
+    Eigen::Vector3d mesh_min;
+    Eigen::Vector3d mesh_max;
+    if (!ComputeAxisAlignedBoundingBox(vertices, mesh_min, mesh_max)) {
+        std::cerr << "Failed to compute AABB of mesh vertices" << std::endl;
+        return false;
+    }
+
+    min = mesh_min.cwiseMax(roi_min);
+    max = mesh_max.cwiseMin(roi_max);
+    if (min.x() > max.x() || min.y() > max.y() || min.z() > max.z()) {
+        return false;
+    }
+
+    if (fill) {
+        min.z() = mesh_min.z();
+        max.z() = mesh_max.z();
+    }
+    return true;
+}
+
+template <typename Discretizer>
+void ExtractVoxelsInRegion(
+    const VoxelGrid<Discretizer>& vg,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels)
+{
+    GridCoord min =
+            vg.worldToGrid(WorldCoord(roi_min.x(), roi_min.y(), roi_min.z()));
+    GridCoord max =
+            vg.worldToGrid(WorldCoord(roi_max.x(), roi_max.y(), roi_max.z()));
+    min.x = std::max(min.x, vg.minGridCoord().x);
+    min.y = std::max(min.y, vg.minGridCoord().y);
+    min.z = std::max(min.z, vg.minGridCoord().z);
+    max.x = std::min(max.x, vg.maxGridCoord().x);
+    max.y = std::min(max.y, vg.maxGridCoord().y);
+    max.z = std::min(max.z, vg.maxGridCoord().z);
+
+    for (int x = min.x; x <= max.x; ++x) {
+        for (int y = min.y; y <= max.y; ++y) {
+            for (int z = min.z; z <= max.z; ++z) {
+                const GridCoord gc(x, y, z);
+                if (vg[gc]) {
+                    const WorldCoord wc = vg.gridToWorld(gc);
+                    voxels.push_back(Eigen::Vector3d(wc.x, wc.y, wc.z));
                 }
             }
         }
     }
 }
 
-void TransformVertices(
-    const Eigen::Affine3d& transform,
-    std::vector<Eigen::Vector3d>& vertices)
+// Append the keys of the voxels of each sphere in a list, including voxels
+// shared between spheres. On failure, no keys are appended.
+bool VoxelizeSphereListKeys(
+    const std::vector<double>& radii,
+    const std::vector<Eigen::Affine3d>& poses,
+    double res,
+    std::vector<VoxelKey>& keys,
+    bool fill,
+    Separability sep)
 {
-    for (size_t i = 0; i < vertices.size(); i++) {
-        vertices[i] = transform * vertices[i];
+    const size_t base = keys.size();
+    for (size_t i = 0; i < radii.size(); i++) {
+        std::vector<Eigen::Vector3d> vertices;
+        std::vector<int> indices;
+        CreateIndexedSphereMesh(radii[i], 9, 10, vertices, indices);
+        TransformVertices(poses[i], vertices);
+        if (!VoxelizeMesh(vertices, indices, res, keys, fill, sep)) {
+            keys.resize(base);
+            return false;
+        }
     }
+    return true;
 }
 
 double Distance(
@@ -686,12 +483,13 @@ void VoxelizeBox(
     double height,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedBoxMesh(length, width, height, vertices, triangles);
-    VoxelizeMesh(vertices, triangles, res, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxels, fill, sep);
 }
 
 /// \brief Voxelize a box at a given pose
@@ -704,13 +502,14 @@ void VoxelizeBox(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedBoxMesh(length, width, height, vertices, triangles);
     TransformVertices(pose, vertices);
-    VoxelizeMesh(vertices, triangles, res, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxels, fill, sep);
 }
 
 void VoxelizeBox(
@@ -720,12 +519,13 @@ void VoxelizeBox(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedBoxMesh(length, width, height, vertices, triangles);
-    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill, sep);
 }
 
 void VoxelizeBox(
@@ -736,13 +536,14 @@ void VoxelizeBox(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedBoxMesh(length, width, height, vertices, triangles);
     TransformVertices(pose, vertices);
-    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill, sep);
 }
 
 /// \brief Voxelize a sphere at the origin
@@ -752,13 +553,14 @@ void VoxelizeSphere(
     double radius,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: make lng_count and lat_count lines configurable or parameters
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedSphereMesh(radius, 7, 8, vertices, triangles);
-    VoxelizeMesh(vertices, triangles, res, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxels, fill, sep);
 }
 
 /// \brief Voxelize a sphere at a given pose
@@ -769,14 +571,15 @@ void VoxelizeSphere(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: make lng_count and lat_count lines configurable or parameters
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedSphereMesh(radius, 7, 8, vertices, triangles);
     TransformVertices(pose, vertices);
-    VoxelizeMesh(vertices, triangles, res, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxels, fill, sep);
 }
 
 /// \brief Voxelize a sphere at the origin using a specified origin for the
@@ -788,13 +591,14 @@ void VoxelizeSphere(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: make lng_count and lat_count lines configurable or parameters
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedSphereMesh(radius, 7, 8, vertices, triangles);
-    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill, sep);
 }
 
 /// \brief Voxelize a sphere at a given pose using a specified origin for the
@@ -807,14 +611,15 @@ void VoxelizeSphere(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: make lng_count and lat_count lines configurable or parameters
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedSphereMesh(radius, 7, 8, vertices, triangles);
     TransformVertices(pose, vertices);
-    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill, sep);
 }
 
 /// \brief Voxelize a cylinder at the origin
@@ -825,13 +630,14 @@ void VoxelizeCylinder(
     double length,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: make rim_count configurable or parameters
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedCylinderMesh(radius, length, vertices, triangles);
-    VoxelizeMesh(vertices, triangles, res, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxels, fill, sep);
 }
 
 /// \brief Voxelize a cylinder at a given pose
@@ -843,14 +649,15 @@ void VoxelizeCylinder(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: make rim_count configurable or parameters
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedCylinderMesh(radius, length, vertices, triangles);
     TransformVertices(pose, vertices);
-    VoxelizeMesh(vertices, triangles, res, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxels, fill, sep);
 }
 
 /// \brief Voxelize a cylinder at the origin using a specified origin for the
@@ -863,13 +670,14 @@ void VoxelizeCylinder(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: make rim_count configurable or parameters
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedCylinderMesh(radius, height, vertices, triangles);
-    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill, sep);
 }
 
 /// \brief Voxelize a cylinder at a given pose using a specified origin for the
@@ -883,14 +691,15 @@ void VoxelizeCylinder(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: make rim_count configurable or parameters
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedCylinderMesh(radius, height, vertices, triangles);
     TransformVertices(pose, vertices);
-    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill, sep);
 }
 
 /// \brief Voxelize a cone at the origin
@@ -901,12 +710,13 @@ void VoxelizeCone(
     double height,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedConeMesh(radius, height, vertices, triangles);
-    VoxelizeMesh(vertices, triangles, res, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxels, fill, sep);
 }
 
 /// \brief Voxelize a cone at a given pose
@@ -918,13 +728,14 @@ void VoxelizeCone(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedConeMesh(radius, height, vertices, triangles);
     TransformVertices(pose, vertices);
-    VoxelizeMesh(vertices, triangles, res, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxels, fill, sep);
 }
 
 /// \brief Voxelize a cone at the origin using a specified origin for the voxel
@@ -937,12 +748,13 @@ void VoxelizeCone(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedConeMesh(radius, height, vertices, triangles);
-    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill, sep);
 }
 
 /// \brief Voxelize a cone at a given pose using a specified origin for the
@@ -956,14 +768,15 @@ void VoxelizeCone(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     // TODO: implement
     std::vector<Eigen::Vector3d> vertices;
     std::vector<int> triangles;
     CreateIndexedConeMesh(radius, height, vertices, triangles);
     TransformVertices(pose, vertices);
-    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(vertices, triangles, res, voxel_origin, voxels, fill, sep);
 }
 
 /// \brief Voxelize a mesh at the origin
@@ -974,7 +787,8 @@ void VoxelizeMesh(
     const std::vector<int>& indices,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     if (((int)indices.size()) % 3 != 0) {
         std::cerr << "Incorrect indexed triangles format" << std::endl;
@@ -991,7 +805,7 @@ void VoxelizeMesh(
     const Eigen::Vector3d size = max - min;
     HalfResVoxelGrid vg(min, size, Eigen::Vector3d(res, res, res));
 
-    VoxelizeMesh(vertices, indices, vg, fill);
+    VoxelizeMesh(vertices, indices, vg, fill, sep);
     ExtractVoxels(vg, voxels);
 }
 
@@ -1004,11 +818,12 @@ void VoxelizeMesh(
     const Eigen::Affine3d& pose,
     double res,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> v_copy = vertices;
     TransformVertices(pose, v_copy);
-    VoxelizeMesh(v_copy, triangles, res, voxels, fill);
+    VoxelizeMesh(v_copy, triangles, res, voxels, fill, sep);
 }
 
 /// \brief Voxelize a mesh at the origin using a specified origin for the voxel
@@ -1021,7 +836,8 @@ void VoxelizeMesh(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     if (((int)triangles.size()) % 3 != 0) {
         std::cerr << "Incorrect indexed triangles format" << std::endl;
@@ -1040,7 +856,7 @@ void VoxelizeMesh(
             min, size, Eigen::Vector3d(res, res, res),
             Eigen::Vector3d(voxel_origin.x(), voxel_origin.y(), voxel_origin.z()));
 
-    VoxelizeMesh(vertices, triangles, vg, fill);
+    VoxelizeMesh(vertices, triangles, vg, fill, sep);
     ExtractVoxels(vg, voxels);
 }
 
@@ -1055,16 +871,170 @@ void VoxelizeMesh(
     double res,
     const Eigen::Vector3d& voxel_origin,
     std::vector<Eigen::Vector3d>& voxels,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     std::vector<Eigen::Vector3d> v_copy = vertices;
     TransformVertices(pose, v_copy);
-    VoxelizeMesh(v_copy, indices, res, voxel_origin, voxels, fill);
+    VoxelizeMesh(v_copy, indices, res, voxel_origin, voxels, fill, sep);
 }
 
-/// \brief Voxelize a plane within a given bounding box
-void VoxelizePlane(
-    double a, double b, double c, double d,
+/// \brief Voxelize a mesh at the origin, producing the keys of its voxels
+///
+/// Keys are the grid coordinates of the voxels produced by VoxelizeMesh with
+/// the same resolution, so keys from different meshes may be merged and
+/// deduplicated exactly. Output keys are appended to the input key vector.
+///
+/// \return false, appending no keys, if the mesh is malformed or its voxels
+///     lie beyond the range of voxel keys
+bool VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    std::vector<VoxelKey>& keys,
+    bool fill,
+    Separability sep)
+{
+    if (((int)indices.size()) % 3 != 0) {
+        std::cerr << "Incorrect indexed triangles format" << std::endl;
+        return false;
+    }
+
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+    if (!ComputeAxisAlignedBoundingBox(vertices, min, max)) {
+        std::cerr << "Failed to compute AABB of mesh vertices" << std::endl;
+        return false;
+    }
+
+    const Eigen::Vector3d size = max - min;
+    HalfResVoxelGrid vg(min, size, Eigen::Vector3d(res, res, res));
+
+    VoxelizeMesh(vertices, indices, vg, fill, sep);
+    return ExtractVoxelKeys(vg, keys);
+}
+
+/// \brief Voxelize a mesh at a given pose, producing the keys of its voxels
+///
+/// Output keys are appended to the input key vector.
+///
+/// \return false, appending no keys, on failure
+bool VoxelizeMesh(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    std::vector<VoxelKey>& keys,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> v_copy = vertices;
+    TransformVertices(pose, v_copy);
+    return VoxelizeMesh(v_copy, indices, res, keys, fill, sep);
+}
+
+/// \brief Voxelize the part of a mesh at the origin that lies within a region
+///
+/// Triangles outside the region are skipped and only the grid covering the
+/// region is allocated, so the cost is proportional to the size of the region
+/// rather than that of the mesh. Output voxels are appended to the input voxel
+/// vector.
+void VoxelizeMeshInRegion(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill,
+    Separability sep)
+{
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+    if (!ComputeRegionBounds(
+            vertices, indices, roi_min, roi_max, fill, min, max))
+    {
+        return;
+    }
+
+    HalfResVoxelGrid vg(min, max - min, Eigen::Vector3d(res, res, res));
+    VoxelizeMesh(vertices, indices, vg, fill, sep);
+    ExtractVoxelsInRegion(vg, roi_min, roi_max, voxels);
+}
+
+/// \brief Voxelize the part of a mesh at a given pose that lies within a region
+///
+/// Output voxels are appended to the input voxel vector.
+void VoxelizeMeshInRegion(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> v_copy = vertices;
+    TransformVertices(pose, v_copy);
+    VoxelizeMeshInRegion(v_copy, indices, res, roi_min, roi_max, voxels, fill, sep);
+}
+
+/// \brief Voxelize the part of a mesh at the origin that lies within a region
+///     using a specified origin for the voxel grid
+///
+/// Output voxels are appended to the input voxel vector.
+void VoxelizeMeshInRegion(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill,
+    Separability sep)
+{
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+    if (!ComputeRegionBounds(
+            vertices, indices, roi_min, roi_max, fill, min, max))
+    {
+        return;
+    }
+
+    PivotVoxelGrid vg(
+            min, max - min, Eigen::Vector3d(res, res, res), voxel_origin);
+    VoxelizeMesh(vertices, indices, vg, fill, sep);
+    ExtractVoxelsInRegion(vg, roi_min, roi_max, voxels);
+}
+
+/// \brief Voxelize the part of a mesh at a given pose that lies within a region
+///     using a specified origin for the voxel grid
+///
+/// Output voxels are appended to the input voxel vector.
+void VoxelizeMeshInRegion(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    const Eigen::Vector3d& roi_min,
+    const Eigen::Vector3d& roi_max,
+    std::vector<Eigen::Vector3d>& voxels,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> v_copy = vertices;
+    TransformVertices(pose, v_copy);
+    VoxelizeMeshInRegion(
+            v_copy, indices, res, voxel_origin, roi_min, roi_max, voxels, fill, sep);
+}
+
+/// \brief Voxelize a plane within a given bounding box
+void VoxelizePlane(
+    double a, double b, double c, double d,
     const Eigen::Vector3d& min,
     const Eigen::Vector3d& max,
     double res,
@@ -1094,8 +1064,11 @@ void VoxelizePlane(
 
 /// \brief Encloses a list of spheres with a set of voxels of a given size
 ///
-/// Encloses a list of spheres with a set of voxels of a given size. The generated voxels appear in the frame the
-/// spheres are described in.
+/// Encloses a list of spheres with a set of voxels of a given size. The generated
+/// voxels appear in the frame the spheres are described in.
+///
+/// Voxels shared between spheres are identified exactly by their keys. If
+/// unique is set, only the first occurrence of each voxel is output.
 ///
 /// \param[in] spheres The list of spheres to voxelize
 /// \param[in] res The resolution of the voxel cells
@@ -1109,45 +1082,65 @@ void VoxelizeSphereList(
     std::vector<Eigen::Vector3d>& voxels,
     double& volume,
     bool unique,
-    bool fill)
+    bool fill,
+    Separability sep)
 {
     if (radii.size() != poses.size()) {
         return;
     }
 
-    for (size_t i = 0; i < radii.size(); i++) {
-        std::vector<Eigen::Vector3d> vertices;
-        std::vector<int> indices;
-        CreateIndexedSphereMesh(radii[i], 9, 10, vertices, indices);
+    std::vector<VoxelKey> keys;
+    if (!VoxelizeSphereListKeys(radii, poses, res, keys, fill, sep)) {
+        return;
+    }
 
-        TransformVertices(poses[i], vertices);
+    VoxelKeySet seen;
+    seen.reserve(keys.size());
+    const HalfResDiscretizer disc(res);
+    for (const VoxelKey& key : keys) {
+        if (seen.insert(key) || !unique) {
+            voxels.push_back(Eigen::Vector3d(
+                    disc.continuize(key.x()),
+                    disc.continuize(key.y()),
+                    disc.continuize(key.z())));
+        }
+    }
 
-        std::vector<Eigen::Vector3d> sphere_voxels;
-        VoxelizeMesh(vertices, indices, res, sphere_voxels, fill);
+    volume = seen.size() * res * res * res;
+}
 
-        voxels.insert(voxels.end(), sphere_voxels.begin(), sphere_voxels.end());
+/// \brief Encloses a list of spheres with a set of voxels of a given size,
+///     producing the keys of the voxels
+///
+/// Each voxel shared between spheres is output once, in the order in which it
+/// is first produced. Output keys are appended to the input key vector.
+///
+/// \return false, appending no keys, on failure
+bool VoxelizeSphereList(
+    const std::vector<double>& radii,
+    const std::vector<Eigen::Affine3d>& poses,
+    double res,
+    std::vector<VoxelKey>& keys,
+    bool fill,
+    Separability sep)
+{
+    if (radii.size() != poses.size()) {
+        return false;
     }
 
-    int duplicateIdx = (int)voxels.size();
-    for (int i = 0; i < duplicateIdx; i++) {
-        for (int j = i + 1; j < duplicateIdx; j++) {
-            Eigen::Vector3d dx = voxels[i] = voxels[j];
-
-            // since all voxels are aligned on the same grid, if the distance is
-            // greater than half the resolution, it has to be the same voxel
-            // (really if distance is just less than the resolution)
-            if (dx.squaredNorm() < (res * res) / 4.0) {
-                std::swap(voxels[duplicateIdx - 1], voxels[j]);
-                duplicateIdx--;
-            }
-        }
+    std::vector<VoxelKey> sphere_keys;
+    if (!VoxelizeSphereListKeys(radii, poses, res, sphere_keys, fill, sep)) {
+        return false;
     }
 
-    volume = duplicateIdx * res * res * res;
-
-    if (unique) {
-        voxels.resize(duplicateIdx);
+    VoxelKeySet seen;
+    seen.reserve(sphere_keys.size());
+    for (const VoxelKey& key : sphere_keys) {
+        if (seen.insert(key)) {
+            keys.push_back(key);
+        }
     }
+    return true;
 }
 
 /// \brief a Quick And Dirty (QAD) enclosure of a list of spheres with a set of
@@ -1273,4 +1266,374 @@ void VoxelizeSphereListQAD(
 //    }
 }
 
+/// \brief Count the voxels occupied by a box at the origin
+size_t VoxelizeBoxCount(
+    double length,
+    double width,
+    double height,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    return VoxelizeBoxCount(
+            length, width, height, Eigen::Affine3d::Identity(), res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a box at a given pose
+size_t VoxelizeBoxCount(
+    double length,
+    double width,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> triangles;
+    CreatePosedBoxMesh(length, width, height, pose, vertices, triangles);
+    return VoxelizeMeshCount(vertices, triangles, res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a box at the origin using a
+///     specified origin for the voxel grid
+size_t VoxelizeBoxCount(
+    double length,
+    double width,
+    double height,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    return VoxelizeBoxCount(
+            length, width, height, Eigen::Affine3d::Identity(), res, voxel_origin,
+            fill, sep);
+}
+
+/// \brief Count the voxels occupied by a box at a given pose using a
+///     specified origin for the voxel grid
+size_t VoxelizeBoxCount(
+    double length,
+    double width,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> triangles;
+    CreatePosedBoxMesh(length, width, height, pose, vertices, triangles);
+    return VoxelizeMeshCount(vertices, triangles, res, voxel_origin, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a sphere at the origin
+size_t VoxelizeSphereCount(
+    double radius,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    return VoxelizeSphereCount(
+            radius, Eigen::Affine3d::Identity(), res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a sphere at a given pose
+size_t VoxelizeSphereCount(
+    double radius,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> triangles;
+    CreatePosedSphereMesh(radius, pose, vertices, triangles);
+    return VoxelizeMeshCount(vertices, triangles, res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a sphere at the origin using a
+///     specified origin for the voxel grid
+size_t VoxelizeSphereCount(
+    double radius,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    return VoxelizeSphereCount(
+            radius, Eigen::Affine3d::Identity(), res, voxel_origin,
+            fill, sep);
+}
+
+/// \brief Count the voxels occupied by a sphere at a given pose using a
+///     specified origin for the voxel grid
+size_t VoxelizeSphereCount(
+    double radius,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> triangles;
+    CreatePosedSphereMesh(radius, pose, vertices, triangles);
+    return VoxelizeMeshCount(vertices, triangles, res, voxel_origin, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a cylinder at the origin
+size_t VoxelizeCylinderCount(
+    double radius,
+    double height,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    return VoxelizeCylinderCount(
+            radius, height, Eigen::Affine3d::Identity(), res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a cylinder at a given pose
+size_t VoxelizeCylinderCount(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> triangles;
+    CreatePosedCylinderMesh(radius, height, pose, vertices, triangles);
+    return VoxelizeMeshCount(vertices, triangles, res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a cylinder at the origin using a
+///     specified origin for the voxel grid
+size_t VoxelizeCylinderCount(
+    double radius,
+    double height,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    return VoxelizeCylinderCount(
+            radius, height, Eigen::Affine3d::Identity(), res, voxel_origin,
+            fill, sep);
+}
+
+/// \brief Count the voxels occupied by a cylinder at a given pose using a
+///     specified origin for the voxel grid
+size_t VoxelizeCylinderCount(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> triangles;
+    CreatePosedCylinderMesh(radius, height, pose, vertices, triangles);
+    return VoxelizeMeshCount(vertices, triangles, res, voxel_origin, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a cone at the origin
+size_t VoxelizeConeCount(
+    double radius,
+    double height,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    return VoxelizeConeCount(
+            radius, height, Eigen::Affine3d::Identity(), res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a cone at a given pose
+size_t VoxelizeConeCount(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> triangles;
+    CreatePosedConeMesh(radius, height, pose, vertices, triangles);
+    return VoxelizeMeshCount(vertices, triangles, res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a cone at the origin using a
+///     specified origin for the voxel grid
+size_t VoxelizeConeCount(
+    double radius,
+    double height,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    return VoxelizeConeCount(
+            radius, height, Eigen::Affine3d::Identity(), res, voxel_origin,
+            fill, sep);
+}
+
+/// \brief Count the voxels occupied by a cone at a given pose using a
+///     specified origin for the voxel grid
+size_t VoxelizeConeCount(
+    double radius,
+    double height,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> triangles;
+    CreatePosedConeMesh(radius, height, pose, vertices, triangles);
+    return VoxelizeMeshCount(vertices, triangles, res, voxel_origin, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a mesh at the origin
+///
+/// Equivalent to the size of the output of the corresponding VoxelizeMesh
+/// call, but the voxel grid is counted in place and no voxels are extracted.
+size_t VoxelizeMeshCount(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    if (((int)indices.size()) % 3 != 0) {
+        std::cerr << "Incorrect indexed triangles format" << std::endl;
+        return 0;
+    }
+
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+    if (!ComputeAxisAlignedBoundingBox(vertices, min, max)) {
+        std::cerr << "Failed to compute AABB of mesh vertices" << std::endl;
+        return 0;
+    }
+
+    const Eigen::Vector3d size = max - min;
+    HalfResVoxelGrid vg(min, size, Eigen::Vector3d(res, res, res));
+
+    VoxelizeMesh(vertices, indices, vg, fill, sep);
+    return CountVoxels(vg);
+}
+
+/// \brief Count the voxels occupied by a mesh at a given pose
+size_t VoxelizeMeshCount(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> v_copy = vertices;
+    TransformVertices(pose, v_copy);
+    return VoxelizeMeshCount(v_copy, indices, res, fill, sep);
+}
+
+/// \brief Count the voxels occupied by a mesh at the origin using a specified
+///     origin for the voxel grid
+size_t VoxelizeMeshCount(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    if (((int)indices.size()) % 3 != 0) {
+        std::cerr << "Incorrect indexed triangles format" << std::endl;
+        return 0;
+    }
+
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+    if (!ComputeAxisAlignedBoundingBox(vertices, min, max)) {
+        std::cerr << "Failed to compute AABB of mesh vertices" << std::endl;
+        return 0;
+    }
+
+    const Eigen::Vector3d size = max - min;
+    PivotVoxelGrid vg(
+            min, size, Eigen::Vector3d(res, res, res),
+            Eigen::Vector3d(voxel_origin.x(), voxel_origin.y(), voxel_origin.z()));
+
+    VoxelizeMesh(vertices, indices, vg, fill, sep);
+    return CountVoxels(vg);
+}
+
+/// \brief Count the voxels occupied by a mesh at a given pose using a specified
+///     origin for the voxel grid
+size_t VoxelizeMeshCount(
+    const std::vector<Eigen::Vector3d>& vertices,
+    const std::vector<int>& indices,
+    const Eigen::Affine3d& pose,
+    double res,
+    const Eigen::Vector3d& voxel_origin,
+    bool fill,
+    Separability sep)
+{
+    std::vector<Eigen::Vector3d> v_copy = vertices;
+    TransformVertices(pose, v_copy);
+    return VoxelizeMeshCount(v_copy, indices, res, voxel_origin, fill, sep);
+}
+
+/// \brief Count the voxels occupied by the union of a list of spheres
+///
+/// Each sphere is voxelized separately and merged into a grid spanning all
+/// spheres, so voxels shared between spheres are counted once
+/// without extracting or deduplicating voxel centers. The combined volume is
+/// the returned count times res^3.
+size_t VoxelizeSphereListCount(
+    const std::vector<double>& radii,
+    const std::vector<Eigen::Affine3d>& poses,
+    double res,
+    bool fill,
+    Separability sep)
+{
+    if (radii.size() != poses.size() || radii.empty()) {
+        return 0;
+    }
+
+    std::vector<std::vector<Eigen::Vector3d>> sphere_vertices(radii.size());
+    std::vector<int> indices;
+    Eigen::Vector3d min = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+    Eigen::Vector3d max = -min;
+    for (size_t i = 0; i < radii.size(); i++) {
+        indices.clear();
+        CreateIndexedSphereMesh(radii[i], 9, 10, sphere_vertices[i], indices);
+        TransformVertices(poses[i], sphere_vertices[i]);
+
+        Eigen::Vector3d smin;
+        Eigen::Vector3d smax;
+        ComputeAxisAlignedBoundingBox(sphere_vertices[i], smin, smax);
+        min = min.cwiseMin(smin);
+        max = max.cwiseMax(smax);
+    }
+
+    HalfResVoxelGrid vg(min, max - min, Eigen::Vector3d(res, res, res));
+    for (size_t i = 0; i < radii.size(); i++) {
+        // merge each sphere separately since scan filling the union of
+        // overlapping surfaces would not respect their interiors
+        VoxelizeMesh(sphere_vertices[i], indices, vg, SetFlag(), fill, sep);
+    }
+
+    return CountVoxels(vg);
+}
+
 } // namespace sbpl
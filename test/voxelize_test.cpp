@@ -0,0 +1,199 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the copyright holder nor the names of its
+//       contributors may be used to endorse or promote products derived from
+//       this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//////////////////////////////////////////////////////////////////////////////
+
+// Checks that voxelized meshes are closed: surfaces have no holes where mesh
+// faces lie on cell boundaries, and filling them yields the enclosed volume.
+// Also checks the coverage of a mesh against that of the box it describes.
+
+// standard includes
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+
+// project includes
+#include <sbpl_geometry_utils/mesh_utils.h>
+#include <sbpl_geometry_utils/voxel_grid.h>
+#include <sbpl_geometry_utils/voxelize.h>
+
+using namespace sbpl;
+
+static int failures = 0;
+
+static void Check(bool cond, const char* what)
+{
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static const char* SeparabilityName(Separability sep)
+{
+    switch (sep) {
+    case Separability::Six:             return "Six";
+    case Separability::TwentySix:       return "TwentySix";
+    case Separability::Conservative:    return "Conservative";
+    }
+    return "";
+}
+
+// Voxelize a box, whose faces lie on cell boundaries, at the box's own extent.
+// The surface is the outer layer of the 6 x 6 x 6 cells inside the box.
+static void TestAlignedBoxSurface(Separability sep)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    CreateIndexedBoxMesh(0.3, 0.3, 0.3, vertices, indices);
+
+    const double res = 0.05;
+    std::vector<Eigen::Vector3d> surface;
+    VoxelizeMesh(vertices, indices, res, surface, false, sep);
+    std::vector<Eigen::Vector3d> solid;
+    VoxelizeMesh(vertices, indices, res, solid, true, sep);
+
+    printf("%-13s surface %zu solid %zu\n",
+            SeparabilityName(sep), surface.size(), solid.size());
+    Check(surface.size() == 6 * 6 * 6 - 4 * 4 * 4, "aligned box surface");
+    Check(fabs(solid.size() * res * res * res - 0.027) < 1e-9,
+            "aligned box volume");
+}
+
+// Voxelize and fill the same box in a larger grid, with the given cell size.
+// Every cell inside the box must be filled, and no cell more than one layer
+// outside it.
+static void TestAlignedBoxClosure(Separability sep, const Eigen::Vector3d& res)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    CreateIndexedBoxMesh(0.3, 0.3, 0.3, vertices, indices);
+
+    HalfResVoxelGrid vg(
+            Eigen::Vector3d(-0.4, -0.4, -0.4),
+            Eigen::Vector3d(0.8, 0.8, 0.8),
+            res);
+    VoxelizeMesh(vertices, indices, vg, true, sep);
+
+    int missing = 0;
+    int stray = 0;
+    for (int x = 0; x < vg.sizeX(); ++x) {
+        for (int y = 0; y < vg.sizeY(); ++y) {
+            for (int z = 0; z < vg.sizeZ(); ++z) {
+                const MemoryCoord mc(x, y, z);
+                const WorldCoord wc = vg.memoryToWorld(mc);
+                const Eigen::Vector3d p(wc.x, wc.y, wc.z);
+                const Eigen::Vector3d outside =
+                        (p.cwiseAbs() - Eigen::Vector3d::Constant(0.15))
+                        .cwiseQuotient(res);
+                if (outside.maxCoeff() < 0.0) {
+                    missing += !vg[mc];
+                }
+                else if (outside.maxCoeff() > 1.0) {
+                    stray += vg[mc] != 0;
+                }
+            }
+        }
+    }
+
+    printf("%-13s res (%g, %g, %g) missing %d stray %d\n",
+            SeparabilityName(sep), res.x(), res.y(), res.z(), missing, stray);
+    Check(missing == 0, "aligned box closure");
+    Check(stray == 0, "aligned box bounds");
+}
+
+// Compare the coverage of a box mesh, whose faces lie on cell boundaries,
+// against the coverage of the box itself, with the given cell size. Both
+// sample the same points, which lie clearly inside or outside the box, so
+// every cell must agree.
+static void TestAlignedBoxCoverage(const Eigen::Vector3d& res)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<int> indices;
+    CreateIndexedBoxMesh(0.3, 0.3, 0.3, vertices, indices);
+
+    typedef VoxelGrid<HalfResDiscretizer, float> CoverageGrid;
+    const Eigen::Vector3d origin(-0.25, -0.25, -0.25);
+    const Eigen::Vector3d size(0.5, 0.5, 0.5);
+    CoverageGrid box(
+            origin, size, res,
+            HalfResDiscretizer(res.x()),
+            HalfResDiscretizer(res.y()),
+            HalfResDiscretizer(res.z()));
+    CoverageGrid mesh(
+            origin, size, res,
+            HalfResDiscretizer(res.x()),
+            HalfResDiscretizer(res.y()),
+            HalfResDiscretizer(res.z()));
+
+    const int samples = 4;
+    VoxelizeBoxCoverage(
+            0.3, 0.3, 0.3, Eigen::Affine3d::Identity(), box, samples);
+    VoxelizeMeshCoverage(vertices, indices, mesh, samples);
+
+    const double cell_volume = res.x() * res.y() * res.z();
+    double box_volume = 0.0;
+    double mesh_volume = 0.0;
+    double max_diff = 0.0;
+    for (int x = 0; x < box.sizeX(); ++x) {
+        for (int y = 0; y < box.sizeY(); ++y) {
+            for (int z = 0; z < box.sizeZ(); ++z) {
+                const MemoryCoord mc(x, y, z);
+                box_volume += box[mc] * cell_volume;
+                mesh_volume += mesh[mc] * cell_volume;
+                max_diff = std::max(max_diff, (double)fabs(box[mc] - mesh[mc]));
+            }
+        }
+    }
+
+    printf("coverage res (%g, %g, %g) box %.6f mesh %.6f max diff %.3f\n",
+            res.x(), res.y(), res.z(), box_volume, mesh_volume, max_diff);
+    Check(fabs(box_volume - 0.027) < 1e-6, "aligned box coverage volume");
+    Check(fabs(mesh_volume - 0.027) < 1e-6, "aligned mesh coverage volume");
+    Check(max_diff < 1e-6, "aligned mesh coverage per cell");
+}
+
+int main()
+{
+    const Separability seps[] = {
+        Separability::Six, Separability::TwentySix, Separability::Conservative
+    };
+    for (Separability sep : seps) {
+        TestAlignedBoxSurface(sep);
+        TestAlignedBoxClosure(sep, Eigen::Vector3d(0.05, 0.05, 0.05));
+        TestAlignedBoxClosure(sep, Eigen::Vector3d(0.05, 0.05, 0.1));
+    }
+    TestAlignedBoxCoverage(Eigen::Vector3d(0.05, 0.05, 0.05));
+    TestAlignedBoxCoverage(Eigen::Vector3d(0.05, 0.05, 0.1));
+
+    printf("%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}